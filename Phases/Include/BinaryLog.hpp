@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "LogFormat.hpp"
+#include "LogManager.hpp"
+
+// NanoLog-style logging: every call site registers its format once, the hot path only
+// copies the call site id, the context and the raw arguments into a per-thread staging buffer.
+// BinaryLogBackend turns the records into LogMessages off the producer threads.
+//
+//   BLOG(Warning, "CPU", "core {} at {}%", core, load);
+namespace BinaryLog
+{
+    enum class ArgType : uint8_t
+    {
+        Int,
+        UInt,
+        Float,
+        Str
+    };
+
+    struct Descriptor
+    {
+        std::string_view format; // string literal of the call site
+        severity_level level;
+        std::vector<ArgType> args;
+    };
+
+    // once per call site, returns the id the records carry
+    uint32_t registerDescriptor(Descriptor descriptor);
+
+    // followed by the context (length-prefixed, it may differ per call) and the arguments
+    struct RecordHeader
+    {
+        uint32_t id;
+        uint32_t size; // header included, multiple of 8
+        int64_t time_ns;
+    };
+
+    // single producer (the owning thread) / single consumer (the backend) byte ring
+    class StagingBuffer
+    {
+    private:
+        std::vector<char> storage;
+        alignas(64) std::atomic<uint64_t> head{0}; // written by the producer
+        uint64_t cached_tail = 0;
+        alignas(64) std::atomic<uint64_t> tail{0}; // written by the backend
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};
+        uint64_t pending_skip = 0;
+
+    public:
+        static constexpr uint32_t wrap_marker = UINT32_MAX;
+
+        explicit StagingBuffer(size_t capacity);
+
+        // contiguous space for size bytes, nullptr (and a drop) when the backend is behind
+        char *reserve(size_t size);
+        void commit(size_t size);
+
+        // backend side: calls fn(header, payload) for every committed record
+        template <typename Fn>
+        size_t drain(Fn &&fn)
+        {
+            uint64_t end = head.load(std::memory_order_acquire);
+            uint64_t pos = tail.load(std::memory_order_relaxed);
+            size_t records = 0;
+            while (pos < end)
+            {
+                uint32_t id;
+                std::memcpy(&id, storage.data() + pos % storage.size(), sizeof(id));
+                if (id == wrap_marker)
+                {
+                    pos += storage.size() - pos % storage.size();
+                    continue;
+                }
+                RecordHeader header;
+                std::memcpy(&header, storage.data() + pos % storage.size(), sizeof(header));
+                fn(header, storage.data() + pos % storage.size() + sizeof(header));
+                pos += header.size;
+                ++records;
+            }
+            tail.store(pos, std::memory_order_release);
+            return records;
+        }
+
+        uint64_t takeDropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+        void retire() { retired.store(true, std::memory_order_release); }
+        bool isRetired() const { return retired.load(std::memory_order_acquire); }
+    };
+
+    // staging buffer of the calling thread, registered with the backend on first use
+    StagingBuffer &localBuffer();
+
+    // bytes of one staging buffer, takes effect for threads that have not logged yet
+    void setBufferSize(size_t bytes);
+
+    template <typename T>
+    constexpr ArgType argType()
+    {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, const char *> || std::is_same_v<U, char *> ||
+                      std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>)
+            return ArgType::Str;
+        else if constexpr (std::is_floating_point_v<U>)
+            return ArgType::Float;
+        else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>)
+            return ArgType::Int;
+        else
+        {
+            static_assert(std::is_integral_v<U>, "BLOG arguments must be numbers or strings");
+            return ArgType::UInt;
+        }
+    }
+
+    template <typename T>
+    size_t encodedSize(const T &arg)
+    {
+        if constexpr (argType<T>() == ArgType::Str)
+            return sizeof(uint32_t) + std::string_view(arg).size();
+        else
+            return 8;
+    }
+
+    template <typename T>
+    char *encode(char *out, const T &arg)
+    {
+        if constexpr (argType<T>() == ArgType::Str)
+        {
+            std::string_view text(arg);
+            uint32_t length = static_cast<uint32_t>(text.size());
+            std::memcpy(out, &length, sizeof(length));
+            std::memcpy(out + sizeof(length), text.data(), length);
+            return out + sizeof(length) + length;
+        }
+        else
+        {
+            using Stored = std::conditional_t<argType<T>() == ArgType::Float, double,
+                                              std::conditional_t<argType<T>() == ArgType::Int, int64_t, uint64_t>>;
+            Stored value = static_cast<Stored>(arg);
+            std::memcpy(out, &value, sizeof(value));
+            return out + sizeof(value);
+        }
+    }
+
+    template <severity_level Level, typename Fmt, typename... Args>
+    void log(Fmt, std::string_view context, const Args &...args)
+    {
+        constexpr int expected = LogFormat::placeholders(Fmt::value());
+        static_assert(expected >= 0, "format string has an unmatched brace");
+        static_assert(expected == sizeof...(Args), "format string placeholders do not match the argument count");
+
+        if constexpr (LogFormat::enabled(Level))
+        {
+            // Fmt is unique per call site, so this runs once per call site
+            static const uint32_t id = registerDescriptor(Descriptor{Fmt::value(), Level, {argType<Args>()...}});
+
+            size_t size = (sizeof(RecordHeader) + encodedSize(context) + (size_t{0} + ... + encodedSize(args)) + 7) & ~size_t{7};
+            StagingBuffer &buffer = localBuffer();
+            char *out = buffer.reserve(size);
+            if (!out)
+                return;
+
+            RecordHeader header{id, static_cast<uint32_t>(size),
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch())
+                                    .count()};
+            std::memcpy(out, &header, sizeof(header));
+            out += sizeof(header);
+            out = encode(out, context);
+            ((out = encode(out, args)), ...);
+            buffer.commit(size);
+        }
+    }
+}
+
+// polls every staging buffer and hands the formatted messages to a LogManager in batches.
+// one backend per process; it must be stopped before the manager goes away
+class BinaryLogBackend
+{
+private:
+    LogManager &manager;
+    std::chrono::milliseconds poll_interval;
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop_flag = false;
+    std::vector<LogMessage> batch;
+
+    void run();
+    LogMessage decode(const BinaryLog::RecordHeader &header, const char *payload);
+
+public:
+    BinaryLogBackend(LogManager &manager, std::chrono::milliseconds poll_interval);
+
+    void start();
+    void stop(); // drains what is left first
+    size_t poll(); // one pass over all buffers, returns the records handed over
+
+    BinaryLogBackend(const BinaryLogBackend &) = delete;
+    BinaryLogBackend &operator=(const BinaryLogBackend &) = delete;
+
+    ~BinaryLogBackend();
+};
+
+#define BLOG(level, context, fmt, ...)                                                                       \
+    do                                                                                                       \
+    {                                                                                                        \
+        if constexpr (LogFormat::enabled(severity_level::level))                                             \
+            BinaryLog::log<severity_level::level>(TELEMETRY_FMT(fmt), context, ##__VA_ARGS__);                \
+    } while (0)
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include "LogMessage.hpp"
+#include "Types_of_enums_data/severity_type.hpp"
+
+// fires when every context of the rule logged `level` at least min_count times within window_ms
+struct CorrelationRule
+{
+    std::string name;
+    std::vector<std::string> contexts; // LogMessage::context values, e.g. "CPU", "GPU"
+    severity_level level;
+    int64_t window_ms;
+    size_t min_count = 1;
+};
+
+// streaming join over the message flow, fed in event-time order by LogManager's reorder
+// buffer. each (rule, context) keeps a fixed-size ring of recent matching timestamps in
+// time order: new ones go on the back, expired ones leave from the front, and the kept
+// count is the window's match count. one message costs O(contexts) amortized, no allocation.
+class CorrelationStage
+{
+private:
+    class TimeWindow
+    {
+    private:
+        std::vector<int64_t> times;
+        size_t head = 0; // oldest
+        size_t count = 0;
+
+    public:
+        explicit TimeWindow(size_t capacity);
+        void push(int64_t time); // a time older than the back is kept as the back; drops the oldest when full
+        void evictBefore(int64_t time);
+        size_t size() const { return count; }
+        void clear() { head = count = 0; }
+    };
+
+    struct RuleState
+    {
+        CorrelationRule rule;
+        std::vector<TimeWindow> windows; // one per rule.contexts entry
+        int64_t newest = std::numeric_limits<int64_t>::min(); // latest matching event time seen
+    };
+
+    std::vector<RuleState> rules;
+
+    static LogMessage composite(const RuleState &state, const LogMessage &trigger);
+
+public:
+    void addRule(CorrelationRule rule, size_t window_capacity);
+
+    // composite messages for rules completed by this message are appended to out
+    void onMessage(const LogMessage &message, std::vector<LogMessage> &out);
+
+    bool empty() const { return rules.empty(); }
+};
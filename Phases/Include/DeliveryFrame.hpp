@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// wire format of acknowledged delivery between a WAL-backed sender and its receiver.
+// sender -> receiver: u32 size, u32 type, u64 value, payload (size counts type onward)
+//   Hello  value = sender id, sent once per connection
+//   Data   value = WAL seq, payload = one record
+// receiver -> sender: bare u64, the highest seq the receiver is done with (cumulative)
+namespace DeliveryFrame
+{
+    enum class Type : uint32_t
+    {
+        Hello = 0x484c4157, // "WALH"
+        Data = 0x444c4157,  // "WALD"
+    };
+
+    struct Frame
+    {
+        Type type;
+        uint64_t value;
+        std::string_view payload; // points into the parsed buffer
+    };
+
+    void put(std::string &out, Type type, uint64_t value, std::string_view payload = {});
+
+    // one frame from the front of data. used = bytes consumed, 0 when incomplete;
+    // nullopt with used > 0 means a malformed frame was skipped
+    std::optional<Frame> parse(std::string_view data, size_t &used);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include "Expression.hpp"
+#include "LineParser.hpp"
+#include "nlohmann_json/json.hpp"
+
+// metrics computed from the fields of one kv/csv sample, configured as the array
+//   [ { "name": "cpu_total", "expr": "avg(cpu*)", "policy": "cpu" },
+//     { "name": "ram_pct", "expr": "100 * ram_used / ram_total", "policy": "ram" } ]
+// ("derived.metrics" for the app's sources, "derived" of a pipeline parse stage)
+// every expression is compiled once; compute() binds the sample's fields into a flat
+// value array and runs the bytecode, allocating nothing. one instance per source thread
+class DerivedMetrics
+{
+public:
+    struct Derived
+    {
+        std::string name;   // app name of the produced messages
+        std::string policy; // Formatter policy the value goes through
+        Expression expr;
+    };
+
+private:
+    VariableTable table;
+    std::vector<Derived> derived;
+
+    std::vector<double> values;
+    std::vector<PrefixStats> prefix_stats;
+    std::vector<double> regs;
+
+    // slots of the field names seen at each position of the last line. a source sends the
+    // same layout line after line, so binding is a string compare instead of lookups
+    struct Binding
+    {
+        std::string name;
+        int slot; // -1 when no expression uses the field itself
+        size_t first_prefix, prefix_end; // range in binding_prefixes
+    };
+    std::vector<Binding> layout;
+    std::vector<uint16_t> binding_prefixes;
+
+    const Binding &binding(size_t position, std::string_view name);
+
+    void bind(const std::vector<MetricField> &fields);
+
+public:
+    // throws std::runtime_error for a malformed entry or expression
+    explicit DerivedMetrics(const nlohmann::json &specs);
+
+    bool empty() const { return derived.empty(); }
+
+    // fn(const Derived &, double value) for every expression whose inputs are all present
+    template <typename Fn>
+    void compute(const std::vector<MetricField> &fields, Fn &&fn)
+    {
+        if (derived.empty())
+            return;
+        bind(fields);
+        for (const auto &d : derived)
+        {
+            double value = d.expr.evaluate(values.data(), prefix_stats.data(), regs.data());
+            if (std::isfinite(value))
+                fn(d, value);
+        }
+    }
+};
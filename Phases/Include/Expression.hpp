@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// names an Expression refers to, shared by every expression evaluated on the same sample.
+// a slot is an index into the values the caller binds before evaluating
+class VariableTable
+{
+private:
+    std::map<std::string, uint16_t, std::less<>> variables;
+    std::map<std::string, uint16_t, std::less<>> prefixes; // "cpu" for sum(cpu*)
+
+public:
+    uint16_t variable(std::string_view name);
+    uint16_t prefix(std::string_view name);
+
+    size_t variableCount() const { return variables.size(); }
+    size_t prefixCount() const { return prefixes.size(); }
+
+    // slot of name, or -1
+    int find(std::string_view name) const;
+    // calls fn(slot) for every prefix name starts with
+    template <typename Fn>
+    void forPrefixesOf(std::string_view name, Fn &&fn) const
+    {
+        for (const auto &[prefix, slot] : prefixes)
+            if (name.substr(0, prefix.size()) == prefix)
+                fn(slot);
+    }
+};
+
+// fold of every field whose name starts with one prefix, for sum(cpu*) and friends
+struct PrefixStats
+{
+    double sum = 0;
+    double min = std::numeric_limits<double>::quiet_NaN();
+    double max = std::numeric_limits<double>::quiet_NaN();
+    uint32_t count = 0;
+
+    void add(double value);
+};
+
+// arithmetic over a sample's fields, compiled once into flat register bytecode:
+//   + - * /  unary -  ( )  numbers  field names
+//   min(a, b, ..)  max(a, b, ..)  abs(x)
+//   sum(p*)  avg(p*)  min(p*)  max(p*)  count(p*)   over fields named p...
+// evaluate() walks the instructions over a caller-owned register file, no allocation.
+// a missing field is NaN and makes the result NaN
+class Expression
+{
+public:
+    enum class Op : uint8_t
+    {
+        Const,
+        Var,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Neg,
+        Min,
+        Max,
+        Abs,
+        PrefixSum,
+        PrefixAvg,
+        PrefixMin,
+        PrefixMax,
+        PrefixCount,
+    };
+
+    struct Instr
+    {
+        Op op;
+        uint16_t dst;
+        uint16_t a; // register, or variable / prefix slot
+        uint16_t b;
+        double constant;
+    };
+
+private:
+    std::vector<Instr> code;
+    uint16_t register_count = 0;
+
+    friend class ExpressionCompiler;
+
+public:
+    // throws std::runtime_error naming the position of a syntax error
+    static Expression compile(std::string_view text, VariableTable &table);
+
+    size_t registers() const { return register_count; }
+
+    // regs: at least registers() doubles
+    double evaluate(const double *variables, const PrefixStats *prefixes, double *regs) const;
+};
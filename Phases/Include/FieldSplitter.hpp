@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// splits a line on a single-byte delimiter.
+// like simdjson's structural index: compare 16 bytes at once, turn the matches
+// into a bitmask and walk the set bits, so the scan is branch-free per byte.
+class FieldSplitter
+{
+public:
+    static void split(std::string_view line, char delim, std::vector<std::string_view> &fields)
+    {
+        fields.clear();
+
+        const char *data = line.data();
+        size_t size = line.size();
+        size_t start = 0;
+        size_t i = 0;
+
+#if defined(__SSE2__)
+        const __m128i pattern = _mm_set1_epi8(delim);
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)));
+
+            while (mask != 0)
+            {
+                size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+                fields.push_back(trim(line.substr(start, pos - start)));
+                start = pos + 1;
+                mask &= mask - 1; // clear lowest set bit
+            }
+        }
+#endif
+        // scalar tail (and whole line without SSE2)
+        for (; i < size; ++i)
+        {
+            if (data[i] == delim)
+            {
+                fields.push_back(trim(line.substr(start, i - start)));
+                start = i + 1;
+            }
+        }
+        fields.push_back(trim(line.substr(start)));
+    }
+
+    static std::string_view trim(std::string_view field)
+    {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t'))
+            field.remove_prefix(1);
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r'))
+            field.remove_suffix(1);
+        return field;
+    }
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <optional>
 #include <chrono>
 #include <sstream>
@@ -11,6 +13,7 @@
 #include "policy/CPU_policy.hpp"
 #include "policy/GPU_policy.hpp"
 #include "policy/RAM_policy.hpp"
+#include "policy/IO_policy.hpp"
 
 template <typename Policy>
 class Formatter
@@ -28,6 +31,15 @@ public:
             return std::nullopt;
         }
 
+        return format(value);
+    }
+
+    // event_time_ms: epoch ms supplied by the source, formatting time when absent
+    static LogMessage format(float value, std::optional<int64_t> event_time_ms = std::nullopt)
+    {
+        auto when = event_time_ms ? std::chrono::system_clock::time_point(std::chrono::milliseconds(*event_time_ms))
+                                  : std::chrono::system_clock::now();
+
         auto sev = Policy::inferSeverity(value);
         std::string description = valueDescription(value, sev);
         std::string app_name = std::string(magic_enum::enum_name(Policy::context));
@@ -38,11 +50,19 @@ public:
             contextStr,
             description,
             sev,
-            currentTimeStamp()};
+            currentTimeStamp(when)};
+        msg.event_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(when.time_since_epoch()).count();
 
         return msg;
     }
 
+    // re-run the policy on an already built message (archive reprocessing)
+    static void reclassify(LogMessage &msg, float value)
+    {
+        msg.level = Policy::inferSeverity(value);
+        msg.message = valueDescription(value, msg.level);
+    }
+
 private:
     static std::string valueDescription(float value, severity_level sev)
     {
@@ -61,9 +81,8 @@ private:
         }
     }
 
-    static std::string currentTimeStamp()
+    static std::string currentTimeStamp(std::chrono::system_clock::time_point now)
     {
-        auto now = std::chrono::system_clock::now();
         std::time_t t = std::chrono::system_clock::to_time_t(now);
         std::tm tm = *std::localtime(&t);
         std::ostringstream ss;
@@ -71,3 +90,29 @@ private:
         return ss.str();
     }
 };
+
+// value -> LogMessage through the policy named in config ("cpu", "ram", "gpu", "io")
+inline std::optional<LogMessage> formatWithPolicy(std::string_view policy, float value,
+                                                  std::optional<int64_t> event_time_ms = std::nullopt)
+{
+    if (policy == "cpu")
+        return Formatter<CPU_policy>::format(value, event_time_ms);
+    if (policy == "ram")
+        return Formatter<RAM_policy>::format(value, event_time_ms);
+    if (policy == "gpu")
+        return Formatter<GPU_policy>::format(value, event_time_ms);
+    if (policy == "io")
+        return Formatter<IO_policy>::format(value, event_time_ms);
+    return std::nullopt;
+}
+
+inline std::optional<LogMessage> formatWithPolicy(std::string_view policy, std::string_view raw_value,
+                                                  std::optional<int64_t> event_time_ms = std::nullopt)
+{
+    float value;
+    auto [end, ec] = std::from_chars(raw_value.data(), raw_value.data() + raw_value.size(), value);
+    if (ec != std::errc())
+        return std::nullopt;
+
+    return formatWithPolicy(policy, value, event_time_ms);
+}
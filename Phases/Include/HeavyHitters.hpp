@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LogMessage.hpp"
+
+// space-saving top-k counter (Metwally et al.) over a stream of keys, in constant memory:
+// at most capacity keys are tracked, an unknown key takes over the smallest counter and
+// inherits its count as error. any key seen more than total/capacity times is tracked,
+// and count - error <= true count <= count.
+// counters sit in count-ordered buckets (stream summary), so add() is O(1): a counter
+// moves at most one bucket up. the key index is a fixed open-addressing table
+class SpaceSaving
+{
+public:
+    struct Entry
+    {
+        std::string key;
+        uint64_t count;
+        uint64_t error; // over-estimation bound
+    };
+
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    struct Counter
+    {
+        std::string key;
+        uint64_t error = 0;
+        uint32_t bucket = none;
+        uint32_t prev = none, next = none; // within the bucket
+    };
+
+    struct Bucket
+    {
+        uint64_t count = 0;
+        uint32_t first = none;             // counters
+        uint32_t prev = none, next = none; // buckets, ascending count
+    };
+
+    size_t capacity;
+    std::vector<Counter> counters;
+    std::vector<Bucket> buckets;       // capacity slots, free ones chained by next
+    uint32_t free_bucket = none;
+    uint32_t min_bucket = none;        // smallest count
+    uint32_t max_bucket = none;
+    std::vector<uint32_t> index;       // key hash -> counter, linear probing
+    uint64_t total = 0;
+
+    size_t slotOf(std::string_view key) const;
+    uint32_t find(std::string_view key) const;
+    void indexInsert(uint32_t counter);
+    void indexErase(std::string_view key);
+
+    uint32_t newBucket(uint64_t count, uint32_t after);
+    void unlink(uint32_t counter);
+    void attach(uint32_t counter, uint32_t bucket);
+    void increment(uint32_t counter);
+
+public:
+    explicit SpaceSaving(size_t capacity);
+
+    void add(std::string_view key);
+    // top n by count, highest first
+    std::vector<Entry> top(size_t n) const;
+    uint64_t totalCount() const { return total; }
+    size_t size() const { return counters.size(); }
+    void clear();
+};
+
+// hottest sources on the ingest path: messages per source, and Critical messages per source,
+// counted over one report interval. the source is the read loop's identity, not the app name
+// (several sources can share one policy)
+class HotSources
+{
+private:
+    std::mutex mtx;
+    SpaceSaving messages;
+    SpaceSaving critical;
+    size_t top_n;
+
+public:
+    HotSources(size_t capacity, size_t top_n);
+
+    void record(const std::string &source, const LogMessage &message);
+
+    std::vector<SpaceSaving::Entry> topMessages();
+    std::vector<SpaceSaving::Entry> topCritical();
+
+    // "topk" records for the interval that ends now, context "messages" and "critical",
+    // then starts a new interval
+    std::vector<LogMessage> report();
+};
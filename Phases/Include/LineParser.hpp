@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include "FieldSplitter.hpp"
+#include "Types_of_enums_data/line_format.hpp"
+
+struct MetricField
+{
+    std::string_view policy; // "cpu", "ram", "gpu", ...
+    std::string_view value;
+};
+
+// turns one raw source line into (policy, value) pairs.
+// views point into the line or the stored csv header, valid until the next parse().
+// a "ts" key/column is the event time in epoch ms and is not reported as a metric
+class LineParser
+{
+private:
+    line_format format;
+    char delimiter;
+    std::string default_policy;
+
+    std::vector<std::string> header; // csv column names, taken from the first line
+    std::vector<std::string_view> fields;
+    std::vector<MetricField> result;
+    std::optional<int64_t> event_time;
+
+    void addField(std::string_view policy, std::string_view value);
+
+public:
+    LineParser(line_format format, std::string default_policy, char delimiter = ',');
+
+    const std::vector<MetricField> &parse(std::string_view line);
+
+    // event time of the last parsed line, if the source sent one
+    std::optional<int64_t> eventTime() const { return event_time; }
+
+    static line_format formatFromString(const std::string &name);
+};
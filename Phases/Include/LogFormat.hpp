@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include "LogMessage.hpp"
+#include "Types_of_enums_data/severity_type.hpp"
+
+// lowest level compiled in, e.g. -DTELEMETRY_MIN_SEVERITY=Warning
+// (CMake: ITI_MIN_SEVERITY, Debug builds default to Debug, others to Info)
+#ifndef TELEMETRY_MIN_SEVERITY
+#define TELEMETRY_MIN_SEVERITY Info
+#endif
+
+namespace LogFormat
+{
+    constexpr severity_level min_severity = severity_level::TELEMETRY_MIN_SEVERITY;
+
+    constexpr bool enabled(severity_level level)
+    {
+        return severityRank(level) >= severityRank(min_severity);
+    }
+
+    // number of "{}" placeholders, -1 for a stray brace; "{{" and "}}" are literal braces
+    constexpr int placeholders(std::string_view fmt)
+    {
+        int count = 0;
+        for (size_t i = 0; i < fmt.size(); ++i)
+        {
+            if (fmt[i] == '{')
+            {
+                if (i + 1 < fmt.size() && fmt[i + 1] == '{')
+                    ++i;
+                else if (i + 1 < fmt.size() && fmt[i + 1] == '}')
+                    ++count, ++i;
+                else
+                    return -1;
+            }
+            else if (fmt[i] == '}')
+            {
+                if (i + 1 < fmt.size() && fmt[i + 1] == '}')
+                    ++i;
+                else
+                    return -1;
+            }
+        }
+        return count;
+    }
+
+    // next literal run of fmt starting at pos, written to os; returns the position after the next "{}"
+    inline size_t writeLiteral(std::ostream &os, std::string_view fmt, size_t pos)
+    {
+        while (pos < fmt.size())
+        {
+            char c = fmt[pos];
+            if (c == '{' && fmt[pos + 1] == '}')
+                return pos + 2;
+            os << c;
+            pos += (c == '{' || c == '}') ? 2 : 1; // escaped brace
+        }
+        return pos;
+    }
+
+    // Fmt is the type made by TELEMETRY_FMT, Args are the captured copies
+    template <typename Fmt, typename... Args>
+    class Deferred : public DeferredText
+    {
+        std::tuple<Args...> args;
+
+    public:
+        template <typename... In>
+        explicit Deferred(In &&...in) : args(std::forward<In>(in)...) {}
+
+        std::string render() const override
+        {
+            constexpr std::string_view fmt = Fmt::value();
+            std::ostringstream os;
+            size_t pos = 0;
+            std::apply([&](const auto &...arg)
+                       { ((pos = writeLiteral(os, fmt, pos), os << arg), ...); },
+                       args);
+            writeLiteral(os, fmt, pos);
+            return os.str();
+        }
+    };
+}
+
+// format string as a type, so its placeholders can be checked against the arguments at compile time
+#define TELEMETRY_FMT(str)                                         \
+    [] {                                                           \
+        struct Fmt                                                 \
+        {                                                          \
+            static constexpr std::string_view value() { return str; } \
+        };                                                         \
+        return Fmt{};                                              \
+    }()
+
+// TLOG(manager, Debug, "cpu {} at {}", value, core);
+// below TELEMETRY_MIN_SEVERITY the arguments are not even evaluated, the format is still checked
+#define TLOG(manager, level, fmt, ...)                                                                        \
+    do                                                                                                        \
+    {                                                                                                         \
+        if constexpr (LogFormat::enabled(severity_level::level))                                              \
+            (manager).log<severity_level::level>(TELEMETRY_FMT(fmt), ##__VA_ARGS__);                           \
+    } while (0)
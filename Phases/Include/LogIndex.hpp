@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <limits>
+#include "LogMessage.hpp"
+
+// sidecar index "<log>.idx" written next to a text log by FileSinkImpl.
+// one fixed-size record per block of lines, so a reader can skip blocks
+// by time range, severity and context without touching the log itself.
+struct LogIndexBlock
+{
+    uint64_t offset;        // byte offset of the first line in the log
+    uint64_t length;        // bytes covered by the block
+    int64_t min_time_ms;    // event time range of the block
+    int64_t max_time_ms;
+    uint32_t severity_mask; // bit per severity_level
+    uint32_t context_mask;  // bit per enum_telem_src, bit 31 for other contexts
+    int64_t max_time_upto_ms; // max_time_ms of this block and all before it, never decreases
+};
+
+namespace LogIndex
+{
+    constexpr char magic[8] = {'L', 'O', 'G', 'I', 'D', 'X', '0', '2'};
+
+    uint32_t severityBit(severity_level level);
+    uint32_t contextBit(std::string_view context);
+
+    std::string indexPath(const std::string &log_path);
+
+    // all complete blocks of the index, empty when missing or malformed
+    std::vector<LogIndexBlock> read(const std::string &index_path);
+
+    // first block that can hold time_ms: binary search on max_time_upto_ms, every block
+    // before it ends before time_ms. late arrivals only make the search stop earlier
+    size_t seek(const std::vector<LogIndexBlock> &blocks, int64_t time_ms);
+
+    // fills max_time_upto_ms of blocks from their max_time_ms
+    void accumulate(std::vector<LogIndexBlock> &blocks);
+}
+
+class LogIndexWriter
+{
+private:
+    std::ofstream index;
+    size_t block_lines;
+
+    LogIndexBlock block{};
+    size_t lines = 0;
+    int64_t max_upto = std::numeric_limits<int64_t>::min();
+
+    void resetBlock(uint64_t offset);
+    void writeBlock();
+
+public:
+    // append: continue an existing index, start_offset is the current log size
+    LogIndexWriter(const std::string &log_path, size_t block_lines, bool append = false, uint64_t start_offset = 0);
+
+    // end: log position right after the line
+    void add(const LogMessage &message, uint64_t end);
+    // same, from a line's event time and LogIndex bits recorded earlier
+    void add(int64_t time_ms, uint32_t severity_bit, uint32_t context_bit, uint64_t end);
+    void close(); // writes the open block (shutdown)
+    void flush() { index.flush(); }
+
+    LogIndexWriter(LogIndexWriter &&) = default;
+    ~LogIndexWriter();
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "LogSegments.hpp"
+#include "TokenBucket.hpp"
+
+struct MaintenanceConfig
+{
+    std::string dir;
+    std::string prefix;
+    int64_t period_ms;               // segment length, used to know when a segment is closed
+    int interval_s = 60;             // time between passes
+    int64_t max_age_ms = 0;          // delete raw segments older than this, 0 = off
+    uint64_t max_total_bytes = 0;    // delete oldest raw segments above this, 0 = off
+    int64_t downsample_after_ms = 0; // replace raw segments by per-minute summaries, 0 = off
+    uint64_t compact_below_bytes = 0; // merge consecutive closed segments smaller than this, 0 = off
+    double io_bytes_per_s = 0;       // token bucket for maintenance reads/writes, 0 = unlimited
+    bool idle_io_priority = true;    // ioprio IDLE class for the maintenance thread
+};
+
+// background retention / downsampling / compaction for SegmentedFileSinkImpl output.
+// runs on its own thread at idle I/O priority and through a token bucket, and never
+// touches the newest segment (the one FileSinkImpl is still appending to)
+class LogMaintenance
+{
+private:
+    MaintenanceConfig cfg;
+    TokenBucket bucket;
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop_flag = false;
+
+    void run();
+    void pass();
+
+    bool isClosed(const LogSegment &segment, const LogSegment *next, int64_t now_ms) const;
+    void downsample(const LogSegment &segment);
+    void append(const LogSegment &into, const LogSegment &from);
+    void removeSegment(const LogSegment &segment);
+    uint64_t segmentBytes(const LogSegment &segment) const;
+
+public:
+    explicit LogMaintenance(MaintenanceConfig config);
+
+    void start();
+    void stop();
+
+    LogMaintenance(const LogMaintenance &) = delete;
+    LogMaintenance &operator=(const LogMaintenance &) = delete;
+
+    ~LogMaintenance();
+};
@@ -2,10 +2,30 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <condition_variable>
 #include "LogMessage.hpp"
+#include "LogFormat.hpp"
 #include "sinks/ILogSink.hpp"
 #include "RingBuffer.hpp"
 #include "ThreadPool.hpp"
+#include "ReorderBuffer.hpp"
+#include "CorrelationStage.hpp"
+
+class LogProducer;
+class LogManager;
+
+// shared by a manager and its producers, so it outlives whichever goes first. a producer
+// detaches under mtx; ~LogManager clears manager and releases the producers under it
+struct ProducerLink
+{
+    explicit ProducerLink(LogManager *manager) : manager(manager) {}
+
+    std::mutex mtx; // taken before producers_mutex
+    LogManager *manager;
+};
 
 class LogManager
 {
@@ -14,12 +34,67 @@ private:
     RingBuffer<LogMessage> messages;
     std::unique_ptr<ThreadPool> pool;
 
+    std::mutex write_mutex; // one writer at a time keeps sink output ordered
+    std::optional<ReorderBuffer> reorder;
+    CorrelationStage correlation;
+    std::vector<LogMessage> composites;
+
+    // in-process producers staging for this manager, see LogProducer
+    std::mutex producers_mutex; // taken before a producer's own mutex
+    std::condition_variable producers_cv;
+    std::vector<LogProducer *> producers;
+    std::thread sweeper; // hands over batches staged longer than their producer's max_delay
+    bool stopping = false;
+    std::shared_ptr<ProducerLink> link = std::make_shared<ProducerLink>(this);
+
+    void write_to_sinks(const LogMessage &message);
+    void flush_sinks();
+    void sweep();
+
 public:
-    LogManager(size_t thread_count, size_t capacity)
-        : pool(std::make_unique<ThreadPool>(thread_count)), messages(capacity) {}
+    LogManager(size_t thread_count, size_t capacity, int cpu = -1)
+        : pool(std::make_unique<ThreadPool>(thread_count, cpu)), messages(capacity) {}
     void add_sink(std::unique_ptr<ILogSink> sink);
-    void log(const LogMessage &message);
+    void log(const LogMessage &message); // a full ring is drained on the calling thread
+    // one ring lock for the whole batch; a full ring is drained on the calling thread, nothing is dropped
+    void log_batch(const std::vector<LogMessage> &batch);
     void write();
+    size_t capacity() const { return messages.max_size(); }
+    void flush(); // producers' staged batches, write(), and everything still held for reordering
+
+    std::shared_ptr<ProducerLink> attach(LogProducer &producer);
+    void detach(LogProducer &producer); // hands over what the producer still stages, link->mtx held
+    void write_now(const LogMessage &message); // straight to sinks, no ring (batch replay)
+
+    // hold messages up to lateness_ms so sinks see them in event-time order
+    void enable_reorder(int64_t lateness_ms, size_t capacity);
+    size_t late_count();
+
+    // composite message to sinks when the rule's contexts co-occur
+    void add_correlation(CorrelationRule rule, size_t window_capacity);
     LogManager &operator<<(const LogMessage &message);
-    ~LogManager() = default;
+
+    // log<severity_level::Info>(TELEMETRY_FMT("cpu {} on core {}"), value, core), or the TLOG macro.
+    // arguments are copied, the text is formatted on the writer thread
+    template <severity_level Level, typename Fmt, typename... Args>
+    void log(Fmt, Args &&...args)
+    {
+        constexpr int expected = LogFormat::placeholders(Fmt::value());
+        static_assert(expected >= 0, "format string has an unmatched brace");
+        static_assert(expected == sizeof...(Args), "format string placeholders do not match the argument count");
+
+        if constexpr (LogFormat::enabled(Level))
+        {
+            LogMessage msg{"app", "App", "", Level, ""};
+            msg.event_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch())
+                                    .count();
+            msg.deferred = std::make_shared<const LogFormat::Deferred<Fmt, std::decay_t<Args>...>>(std::forward<Args>(args)...);
+            log(msg);
+        }
+    }
+    LogManager(const LogManager &) = delete;
+    LogManager &operator=(const LogManager &) = delete;
+
+    ~LogManager(); // hands over attached producers' batches and writes everything out
 };
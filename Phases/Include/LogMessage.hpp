@@ -3,11 +3,22 @@
 #include <string>
 #include <chrono>
 #include <ctime>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
+#include <optional>
+#include <string_view>
+#include <memory>
 #include "Types_of_enums_data/severity_type.hpp"
 #include "magic_enum/magic_enum.hpp"
 
+// message text that is only built when the message reaches the writer thread
+class DeferredText
+{
+public:
+    virtual ~DeferredText() = default;
+    virtual std::string render() const = 0;
+};
 
 class LogMessage
 {
@@ -18,9 +29,38 @@ public:
     std::string time;
     std::string message;
     std::string context;
+    int64_t event_time_ms = 0; // epoch ms the sample was taken (source supplied or formatting time)
+    uint64_t source_key = 0;   // sourceKey() of the source the message was read from, 0 for the app's own records
+    std::shared_ptr<const DeferredText> deferred; // set: message and time are filled in by render()
 
     LogMessage(const std::string &app, const std::string &cntxt, const std::string &msg, severity_level sev, std::string time);
+
+    // keep moves: messages are shuffled through ring, heap and batch vectors
+    LogMessage(const LogMessage &) = default;
+    LogMessage(LogMessage &&) noexcept = default;
+    LogMessage &operator=(const LogMessage &) = default;
+    LogMessage &operator=(LogMessage &&) noexcept = default;
+
     ~LogMessage() = default;
+
+    // turn a deferred message into a plain one, no-op otherwise
+    void render();
 };
 
 std::ostream &operator<<(std::ostream &os, const LogMessage &msg);
+
+// inverse of operator<<: "[app] [time] [context] [level] [message]" back to a LogMessage
+std::optional<LogMessage> parseLogLine(std::string_view line);
+
+// number in a Formatter description "<Level>: <value><unit>"
+std::optional<float> parseLogValue(std::string_view message);
+
+// "YYYY-MM-DD HH:MM:SS" local time -> epoch ms, 0 when malformed
+int64_t parseTimeStamp(std::string_view time);
+
+// inverse of parseTimeStamp
+std::string formatTimeStamp(int64_t epoch_ms);
+
+// non-zero hash of a source id (configured name or endpoint), not written to the log
+uint64_t sourceKey(std::string_view source);
+
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "LogManager.hpp"
+#include "Formatter.hpp"
+
+// in-process front end for services linking the library: messages are staged in a
+// per-thread batch and handed to LogManager with one ring lock per batch, instead of
+// being encoded as text and sent over a socket.
+// a producer is attached to its manager: the manager's sweeper hands over a batch once
+// its oldest message waited max_delay, and a destroyed manager takes what is still
+// staged and leaves the producer detached (later messages are dropped).
+class LogProducer
+{
+private:
+    friend class LogManager;
+
+    LogManager *manager; // null once detached, guarded by mtx
+    std::shared_ptr<ProducerLink> link; // detach handshake, valid after the manager is gone
+    std::mutex mtx;      // owner thread vs the manager's sweeper, uncontended otherwise
+    std::vector<LogMessage> batch;
+    size_t batch_size;
+    std::chrono::milliseconds max_delay;
+    std::chrono::steady_clock::time_point oldest; // staging time of batch[0]
+
+    void handOver(); // mtx held
+    void flushOlder(std::chrono::steady_clock::time_point now);
+    void release(); // by the manager: hand over and forget it
+    std::chrono::milliseconds maxDelay() const { return max_delay; }
+
+public:
+    explicit LogProducer(LogManager &manager, size_t batch_size = 64,
+                         std::chrono::milliseconds max_delay = std::chrono::milliseconds(100));
+
+    void log(LogMessage message);
+
+    template <typename Policy>
+    void log(float value)
+    {
+        log(Formatter<Policy>::format(value));
+    }
+
+    // hand over what is staged now (idle points, before blocking)
+    void flush();
+
+    // producer of the calling thread for manager, flushed when the thread exits
+    static LogProducer &local(LogManager &manager);
+
+    LogProducer(const LogProducer &) = delete;
+    LogProducer &operator=(const LogProducer &) = delete;
+
+    ~LogProducer();
+};
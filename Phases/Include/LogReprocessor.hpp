@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include "LogMessage.hpp"
+#include "LogManager.hpp"
+
+// batch mode: reads archived output logs back into LogMessages on all cores
+// and replays them, in file order, through the LogManager sinks/correlation.
+class LogReprocessor
+{
+public:
+    struct Stats
+    {
+        size_t bytes = 0;
+        size_t records = 0;
+        size_t rejected = 0; // lines that are not in the LogMessage layout
+        double seconds = 0;
+    };
+
+private:
+    LogManager &logger;
+    size_t thread_count;
+    size_t chunk_bytes;
+    bool reclassify;
+
+    struct Chunk
+    {
+        std::string_view text;
+        std::vector<LogMessage> records;
+        size_t rejected = 0;
+    };
+
+    void parseChunk(Chunk &chunk) const;
+    static void reclassifyRecord(LogMessage &msg);
+
+public:
+    // reclassify: recompute level/description from the logged value with the current policies
+    LogReprocessor(LogManager &logger, size_t thread_count, size_t chunk_bytes, bool reclassify);
+
+    Stats run(const std::vector<std::string> &paths);
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// time-partitioned log segments: "<dir>/<prefix>-YYYYMMDD-HHMMSS.log" (local wall-clock start time),
+// each with the LogIndex sidecar "<segment>.idx". a segment downsampled by LogMaintenance
+// is replaced by "<prefix>-YYYYMMDD-HHMMSS.summary.log" (no index)
+struct LogSegment
+{
+    int64_t start_ms;
+    std::string path;
+    bool summary = false;
+};
+
+namespace LogSegments
+{
+    std::string segmentPath(const std::string &dir, const std::string &prefix, int64_t start_ms);
+
+    std::string summaryPath(const std::string &segment_path);
+
+    // segments of prefix in dir, raw and summary, oldest first
+    std::vector<LogSegment> list(const std::string &dir, const std::string &prefix);
+
+    // deletes whole segments (log + index) that ended before cutoff_ms, never keep_path.
+    // returns the number of segments removed
+    size_t removeOlderThan(const std::string &dir, const std::string &prefix, int64_t period_ms,
+                           int64_t cutoff_ms, const std::string &keep_path);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "safe/SafeMappedFile.hpp"
+
+// one log striped over several directories (one per disk) by StripedFileSinkImpl:
+// "<dir i>/<name>.stripe<i>.log", plus the manifest "<dir 0>/<name>.stripes", a text file
+//   stripes <n>
+//   file <path of stripe i>            n lines
+//   batch <seq> <stripe> <offset> <length> <min_time_ms> <max_time_ms>   per batch, in write order
+struct StripeBatch
+{
+    uint64_t seq;
+    uint32_t stripe;
+    uint64_t offset;
+    uint64_t length;
+    int64_t min_time_ms;
+    int64_t max_time_ms;
+};
+
+struct StripeManifest
+{
+    std::vector<std::string> files;
+    std::vector<StripeBatch> batches;
+
+    // nullopt when missing or without a header; a torn last line is ignored
+    static std::optional<StripeManifest> read(const std::string &path);
+};
+
+namespace LogStripes
+{
+    std::string stripePath(const std::string &dir, const std::string &name, size_t stripe);
+    std::string manifestPath(const std::string &dir, const std::string &name);
+
+    std::string headerLines(const std::vector<std::string> &files);
+    std::string batchLine(const StripeBatch &batch);
+}
+
+// reads the stripes of a manifest back as one stream in event-time order: a k-way merge
+// of the stripes, each read batch by batch in write order. batches outside [from, to] are
+// skipped without being read; lines of the same second keep their write order
+class StripeReader
+{
+private:
+    struct Cursor
+    {
+        std::unique_ptr<SafeMappedFile> file;
+        std::vector<StripeBatch> batches;
+        size_t batch = 0;
+        std::string_view rest; // unread part of the current batch
+        std::string_view line;
+        int64_t time_ms = 0;
+        uint64_t seq = 0;
+    };
+
+    std::vector<Cursor> cursors;
+    std::vector<size_t> heap; // cursor indices, earliest line on top
+    int64_t from;
+    int64_t to;
+    size_t skipped = 0;
+    static constexpr size_t npos = SIZE_MAX;
+    size_t pending = npos; // cursor of the line returned last
+
+    bool advance(Cursor &cursor); // next line in range, false at the end of the stripe
+    bool later(size_t a, size_t b) const;
+
+public:
+    StripeReader(const StripeManifest &manifest, int64_t from_ms = std::numeric_limits<int64_t>::min(),
+                 int64_t to_ms = std::numeric_limits<int64_t>::max());
+
+    // next line without its newline, false when every stripe is done
+    bool next(std::string_view &line);
+
+    size_t skippedBatches() const { return skipped; }
+};
@@ -13,24 +13,71 @@
 #include "telemetry/FileTelemetrySourceImpl.hpp"
 #include "telemetry/SocketTelemetrySourceImpl.hpp"
 #include "Formatter.hpp"
+#include "LineParser.hpp"
+#include "DerivedMetrics.hpp"
+#include "HeavyHitters.hpp"
+#include "StaleSources.hpp"
+#include "LogMaintenance.hpp"
+#include "StagingBackend.hpp"
+#include "ShardedLogManager.hpp"
+#include "SummaryReceiver.hpp"
+#include "TailServer.hpp"
+#include "pipeline/Pipeline.hpp"
+#ifdef ITI_WITH_SOMEIP
 #include "telemetry/SomeIPTelemetrySourceImpl.hpp"
+#endif
+#include "telemetry/CgroupTelemetrySourceImpl.hpp"
+#ifdef ITI_WITH_COROUTINES
+#include "coro/CoroSources.hpp"
+#endif
+#include <functional>
 
 class TelemetryLoggingApp
 {
 private:
     void loadConfig(const std::string &path);
-    void setupSinks();
+    // console, files, segments, archive from a "sinks"-shaped block
+    void setupSinks(std::vector<std::unique_ptr<ILogSink>> &sinks, const nlohmann::json &cfg, const std::string &suffix = "");
+    // edge summaries and live tail, once per sink set of this node
+    void setupNodeSinks(std::vector<std::unique_ptr<ILogSink>> &sinks, const std::string &suffix = "");
+    void setupShards();
     void setupTelemetrySources();
+    void setupPipeline();
+    void setupPipelineSources();
+    void startExecutor();
+    // source loop on its own thread, or as a coroutine when sources.execution is "coroutines"
+    void runPeriodic(int rate_ms, std::function<bool()> setup, std::function<void()> tick);
     void startWriterThread();
+    void startMaintenance();
+    // source threads -> staging queue or LogManager, source is the read loop's identity
+    void emit(LogMessage message, const std::string &source);
+    void route(LogMessage message); // emit() without counting the message as a source sample
+    // one line source's fields, then the "derived" metrics computed from them
+    void emitLine(LineParser &parser, DerivedMetrics *derived, const std::string &source, std::string_view raw);
+    std::shared_ptr<DerivedMetrics> makeDerived(line_format format) const; // nullptr unless "derived" is enabled
 
     nlohmann::json config;
     std::unique_ptr<LogManager> logger;
+    std::unique_ptr<StagingBackend> staging;
+    std::unique_ptr<ShardedLogManager> shards;
+    std::unique_ptr<StagingBackend> shardMerge; // output "merge": shards -> logger
+    std::unique_ptr<SummaryReceiver> summaries;  // central instance of edge pre-aggregation
+    std::shared_ptr<TailServer> tail;            // live-tail endpoint, shared with its sinks
+    std::unique_ptr<Pipeline> pipeline;          // configured stage DAG, used instead of "sources"
+    std::unique_ptr<HotSources> hotSources;      // top-k sources by messages and Critical events
+    int hot_report_ms = 60000;
+    std::unique_ptr<StaleSources> liveness;      // stale-source deadlines, ticked by the writer thread
 
     std::vector<std::unique_ptr<ILogSink>> sinks;
     std::vector<std::unique_ptr<ITelemetrySource>> sources;
     std::vector<std::thread> sourceThreads;
+#ifdef ITI_WITH_COROUTINES
+    std::unique_ptr<coro::EpollExecutor> executor;
+    std::unique_ptr<coro::Event> someipEvent;
+#endif
 
     std::thread writerThread_;
+    std::unique_ptr<LogMaintenance> maintenance;
     int buffer_capacity;
     int thread_pool_size;
     int sink_flush_rate_ms;
@@ -41,6 +88,9 @@ public:
     explicit TelemetryLoggingApp(const std::string &configPath);
     void start();
 
+    // batch mode: replay archived logs through sinks instead of reading live sources
+    void reprocess(const std::vector<std::string> &paths);
+
     static void signalHandler(int);
 
     ~TelemetryLoggingApp();
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include "LogMessage.hpp"
+
+// record filter written as one line of key=value tokens, all of which must match:
+//   level=<L>[,<L>..]  min_level=<L>  context=<c>[,..]  app=<a>[,..]  min=<v>  max=<v>
+// used by live-tail subscriptions and pipeline route stages
+struct MessageFilter
+{
+    uint32_t severity_mask = ~0u; // bit per severity_level value
+    std::set<std::string> contexts;
+    std::set<std::string> apps;
+    std::optional<float> min_value;
+    std::optional<float> max_value;
+
+    // nullopt and error set for an unknown key or value
+    static std::optional<MessageFilter> parse(const std::string &line, std::string &error);
+    std::string key() const; // canonical text, equal filters give equal keys
+    bool needsValue() const { return min_value || max_value; }
+    // value: parseLogValue(message.message), only looked at when needsValue()
+    bool matches(const LogMessage &message, const std::optional<float> &value) const;
+};
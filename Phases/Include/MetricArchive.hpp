@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "safe/SafeMappedFile.hpp"
+
+// round-robin archive of one metric at several resolutions, RRD style.
+// the file size is fixed by the layout, so disk use does not grow with uptime.
+//
+// file: Header | Resolution[count] | cells of resolution 0 | cells of resolution 1 | ...
+// a cell remembers which time slot it holds, so a stale cell from a previous
+// lap of the ring is recognised and reset on the next update (O(1) per resolution).
+class MetricArchive
+{
+public:
+    struct Resolution
+    {
+        int64_t step_ms;
+        uint32_t rows;
+        uint32_t reserved;
+    };
+
+    struct Point
+    {
+        int64_t time_ms; // slot start
+        float min;
+        float max;
+        double avg;
+        uint32_t count;
+    };
+
+private:
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t resolution_count;
+    };
+
+    struct Cell
+    {
+        int64_t slot; // time_ms / step_ms, -1 when empty
+        float min;
+        float max;
+        double sum;
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    static constexpr char magic[8] = {'M', 'E', 'T', 'R', 'R', 'D', '0', '1'};
+
+    SafeMappedFile file;
+    std::vector<Resolution> resolutions;
+    std::vector<Cell *> rings; // first cell of each resolution inside the mapping
+
+    static size_t fileSize(const std::vector<Resolution> &layout);
+    bool layoutMatches() const;
+    void format();
+    void bind();
+
+public:
+    // opens path, (re)initialising it if missing or written with another layout
+    MetricArchive(const std::string &path, std::vector<Resolution> layout);
+
+    // opens an existing archive with the layout stored in it (query side)
+    explicit MetricArchive(const std::string &path);
+
+    // samples before the epoch (time_ms < 0) are ignored
+    void update(int64_t time_ms, float value);
+
+    // points of the finest resolution whose ring still reaches from_ms, nothing before the epoch
+    std::vector<Point> query(int64_t from_ms, int64_t to_ms, int64_t now_ms) const;
+
+    const std::vector<Resolution> &layout() const { return resolutions; }
+    void sync() { file.sync(); }
+
+    static std::vector<Resolution> defaultLayout(); // 1s x 1h, 1m x 1w, 1h x 1y
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LogMessage.hpp"
+
+// log-bucketed quantile sketch (DDSketch): relative error alpha on every quantile,
+// merging two sketches is adding bucket counts, so it is exact and order independent
+class QuantileSketch
+{
+private:
+    static constexpr double alpha = 0.01;
+
+    std::vector<std::pair<int32_t, uint64_t>> buckets; // sorted by index
+    uint64_t zero_count = 0;                            // values <= min_value
+
+    static int32_t bucketOf(double value);
+    static double valueOf(int32_t index);
+
+    friend class MetricSummary;
+
+public:
+    void add(double value, uint64_t count = 1);
+    void merge(const QuantileSketch &other);
+    double quantile(double q) const;
+    uint64_t count() const;
+};
+
+// mergeable statistics of one source over one time window, built at the edge and
+// shipped to a central instance instead of the raw samples
+class MetricSummary
+{
+public:
+    std::string app_name;
+    std::string context;
+    int64_t window_start_ms = 0;
+    int64_t window_ms = 0;
+
+    uint64_t count = 0;
+    float min = 0;
+    float max = 0;
+    double sum = 0;
+    std::array<uint64_t, 4> severity_counts{}; // by severity_level value
+    QuantileSketch sketch;
+
+    void add(float value, severity_level level);
+    void merge(const MetricSummary &other);
+    severity_level worst() const;
+
+    // the summary text the central instance logs, "count=.. min=.. p50=.. .."
+    std::string describe() const;
+    // "summary" app record for the window, context "<app>/<context>" when they differ
+    LogMessage toLogMessage() const;
+
+    // framed binary encoding: u32 payload size, then the payload
+    void serialize(std::string &out) const;
+    // one frame from the front of data, nullopt when incomplete or malformed; used = frame bytes
+    static std::optional<MetricSummary> deserialize(std::string_view data, size_t &used);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include "LogMessage.hpp"
+
+// bounded event-time reorder stage.
+// messages are held in a min-heap on event_time_ms and released once the
+// watermark (newest time seen, or wall clock, minus allowed lateness) passes them.
+// a message older than what was already released is a late arrival: it is still
+// released, right away, and counted.
+class ReorderBuffer
+{
+private:
+    struct Entry
+    {
+        int64_t time;
+        uint64_t seq; // keeps arrival order for equal timestamps
+        LogMessage msg;
+    };
+
+    std::vector<Entry> heap;
+    int64_t lateness_ms;
+    size_t capacity;
+
+    int64_t max_seen = std::numeric_limits<int64_t>::min();
+    int64_t last_released = std::numeric_limits<int64_t>::min();
+    uint64_t next_seq = 0;
+    size_t late = 0;
+
+    LogMessage popTop();
+
+public:
+    ReorderBuffer(int64_t lateness_ms, size_t capacity);
+
+    void push(LogMessage msg);
+
+    // next message whose event time is behind the watermark at now_ms
+    std::optional<LogMessage> popReady(int64_t now_ms);
+
+    // next message regardless of watermark (shutdown flush)
+    std::optional<LogMessage> popAny();
+
+    size_t size() const { return heap.size(); }
+    size_t lateCount() const { return late; }
+};
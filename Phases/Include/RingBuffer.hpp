@@ -51,13 +51,51 @@ public:
         return true;
     }
 
+    bool tryPush(T &&item)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (count == capacity)
+        {
+            return false;
+        }
+
+        buffer[write_index] = std::move(item);
+        write_index = (write_index + 1) % capacity;
+        ++count;
+
+        cv.notify_one();
+        return true;
+    }
+
+    // pushes items[first..first+n) that fit under one lock, returns n
+    size_t tryPushBatch(const std::vector<T> &items, size_t first = 0)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        size_t pushed = 0;
+        for (size_t i = first; i < items.size(); ++i)
+        {
+            if (count == capacity)
+                break;
+            buffer[write_index] = items[i];
+            write_index = (write_index + 1) % capacity;
+            ++count;
+            ++pushed;
+        }
+
+        if (pushed > 0)
+            cv.notify_one();
+        return pushed;
+    }
+
     std::optional<T> trypop()
     {
         std::lock_guard<std::mutex> lock(mtx);
         if (count == 0)
             return std::nullopt;
 
-        T item = buffer[read_index].value(); 
+        T item = std::move(*buffer[read_index]);
         buffer[read_index].reset();          
         read_index = (read_index + 1) % capacity;
         --count;
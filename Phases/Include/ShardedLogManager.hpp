@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LogManager.hpp"
+
+// shared-nothing pipelines: each shard is a LogManager with its own ring, writer thread
+// (pinned to a core) and sinks. every source maps to exactly one shard, by explicit
+// assignment or by its source_key, so shards never share a lock or a sink and all values
+// of one source stay together. the app's own records (no source) hash app + context
+class ShardedLogManager
+{
+private:
+    std::vector<std::unique_ptr<LogManager>> shards;
+    std::unordered_map<std::string, size_t> assignment; // app or context -> shard, fixed after setup
+    std::unordered_map<uint64_t, size_t> source_assignment; // sourceKey of the same keys
+
+public:
+    // shard_count 0: one per online core
+    ShardedLogManager(size_t shard_count, size_t capacity, bool pin_cores);
+
+    size_t size() const { return shards.size(); }
+    LogManager &shard(size_t index) { return *shards[index]; }
+
+    // before logging starts: messages whose source, app_name or context is key go to shard
+    void assign(const std::string &key, size_t shard);
+    size_t shardFor(const LogMessage &message) const;
+
+    void log(const LogMessage &message);
+    void flush();
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_SEARCH_X86 1
+#endif
+
+// substring search for scanning large log regions.
+// AVX2 path (picked at runtime): compare the needle's first and last byte against
+// 32 positions at once and only memcmp where both match. falls back to string_view::find.
+namespace SimdSearch
+{
+    constexpr size_t npos = std::string_view::npos;
+
+#if defined(SIMD_SEARCH_X86)
+    __attribute__((target("avx2"))) inline size_t findAvx2(std::string_view haystack, std::string_view needle, size_t from)
+    {
+        const size_t k = needle.size();
+        const char *data = haystack.data();
+        const __m256i first = _mm256_set1_epi8(needle.front());
+        const __m256i last = _mm256_set1_epi8(needle.back());
+
+        size_t i = from;
+        for (; i + k + 31 <= haystack.size(); i += 32)
+        {
+            __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + k - 1));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))));
+
+            while (mask != 0)
+            {
+                size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+                if (std::memcmp(data + pos, needle.data(), k) == 0)
+                    return pos;
+                mask &= mask - 1;
+            }
+        }
+        return haystack.find(needle, i); // tail shorter than one block
+    }
+#endif
+
+    inline size_t find(std::string_view haystack, std::string_view needle, size_t from = 0)
+    {
+        if (needle.empty() || from >= haystack.size() || haystack.size() - from < needle.size())
+            return needle.empty() ? from : npos;
+
+#if defined(SIMD_SEARCH_X86)
+        static const bool has_avx2 = __builtin_cpu_supports("avx2");
+        if (has_avx2)
+            return findAvx2(haystack, needle, from);
+#endif
+        return haystack.find(needle, from);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// bounded single producer / single consumer queue, no locks. each side caches the
+// other side's index so the common case touches only its own cache line
+template <typename T>
+class SpscQueue
+{
+private:
+    std::vector<std::optional<T>> slots;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> head{0}; // next slot to write, producer
+    size_t cached_tail = 0;
+
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to read, consumer
+    size_t cached_head = 0;
+
+    static size_t roundUp(size_t n)
+    {
+        size_t size = 2;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots(roundUp(capacity)), mask(slots.size() - 1)
+    {
+    }
+
+    bool tryPush(T &&item)
+    {
+        size_t pos = head.load(std::memory_order_relaxed);
+        if (pos - cached_tail == slots.size())
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (pos - cached_tail == slots.size())
+                return false;
+        }
+        slots[pos & mask] = std::move(item);
+        head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side: oldest item or nullptr, valid until pop()
+    T *front()
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        if (pos == cached_head)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            if (pos == cached_head)
+                return nullptr;
+        }
+        return &*slots[pos & mask];
+    }
+
+    void pop()
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        slots[pos & mask].reset();
+        tail.store(pos + 1, std::memory_order_release);
+    }
+
+    size_t max_size() const
+    {
+        return slots.size();
+    }
+};
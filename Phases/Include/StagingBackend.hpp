@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "LogManager.hpp"
+#include "SpscQueue.hpp"
+
+// producer threads log into their own SPSC queue (created on first use, retired when
+// the thread exits); one backend thread polls all of them and hands the messages to
+// LogManager in batches, so producers never contend on the shared ring.
+// with ordered_merge the queues are merged by event_time_ms, holding back messages
+// younger than merge_grace_ms so a slower producer can still slot in before them.
+class StagingBackend
+{
+public:
+    struct Queue
+    {
+        SpscQueue<LogMessage> messages;
+        std::atomic<bool> retired{false};
+        std::atomic<uint64_t> dropped{0};
+
+        explicit Queue(size_t capacity) : messages(capacity) {}
+    };
+
+private:
+    LogManager &manager;
+    size_t queue_capacity;
+    std::chrono::milliseconds poll_interval;
+    bool ordered_merge;
+    int64_t merge_grace_ms;
+    uint64_t id; // thread-local lookups key on this, addresses can be reused
+    size_t handover; // messages per log_batch call, at most the manager's ring
+
+    std::mutex queues_mtx; // registration only, never taken on the push path
+    std::vector<std::shared_ptr<Queue>> queues;
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop_flag = false;
+    std::atomic<bool> draining{false}; // backend thread running, a full queue will empty
+    std::vector<LogMessage> batch;
+
+    Queue &localQueue();
+    void run();
+    size_t drainUnordered(std::vector<std::shared_ptr<Queue>> &snapshot);
+    size_t drainOrdered(std::vector<std::shared_ptr<Queue>> &snapshot, int64_t cutoff_ms);
+
+public:
+    StagingBackend(LogManager &manager, size_t queue_capacity, std::chrono::milliseconds poll_interval,
+                   bool ordered_merge = false, int64_t merge_grace_ms = 0);
+
+    // false when the calling thread's queue is full (message dropped).
+    // wait: retry while the backend thread runs instead (producers that can block, shard writers)
+    bool log(LogMessage message, bool wait = false);
+
+    void start();
+    void stop(); // drains everything, ordered merge ignores the grace period
+    size_t poll(bool final_pass = false); // consumer side: not while the backend thread runs
+
+    StagingBackend(const StagingBackend &) = delete;
+    StagingBackend &operator=(const StagingBackend &) = delete;
+
+    ~StagingBackend();
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LogMessage.hpp"
+#include "TimerWheel.hpp"
+
+// per-source liveness: a source that sends nothing for timeout_ms gets one Critical
+// "liveness" record, and an Info one when it sends again. sources are read loop ids
+// (configured name or endpoint), app names are shared by every source of a policy.
+// seen() only stores the new deadline; the source's wheel timer is left where it is
+// and pushed forward when it fires early, so a sample costs a lookup and a store and
+// a tick costs only the timers that come due
+class StaleSources
+{
+private:
+    struct Source
+    {
+        std::string name;
+        int64_t last_seen_ms = 0;
+        int64_t stale_since_ms = 0; // 0 while alive
+    };
+
+    std::mutex mtx;
+    int64_t timeout_ms;
+    int64_t tick_ms;
+    int64_t origin_ms; // wheel tick 0
+    TimerWheel wheel;
+    std::unordered_map<std::string, TimerWheel::Handle> ids;
+    std::vector<Source> sources; // by handle
+    size_t stale = 0;
+
+    // first tick at or after ms
+    uint64_t tickOf(int64_t ms) const
+    {
+        return ms > origin_ms ? static_cast<uint64_t>((ms - origin_ms + tick_ms - 1) / tick_ms) : 0;
+    }
+    LogMessage record(const Source &source, severity_level level, const std::string &text, int64_t now_ms) const;
+    void add(const std::string &name, int64_t now_ms);
+
+public:
+    StaleSources(int64_t timeout_ms, int64_t tick_ms, int64_t now_ms);
+
+    // a configured source, stale after timeout_ms unless it sends. also catches a source
+    // that is dead from the start, which seen() alone never registers. no-op when known
+    void watch(const std::string &source, int64_t now_ms);
+
+    // a sample from source; its recovery record when it was stale
+    std::optional<LogMessage> seen(const std::string &source, int64_t now_ms);
+
+    // expire deadlines up to now, stale records into out
+    void tick(int64_t now_ms, std::vector<LogMessage> &out);
+
+    size_t size();
+    size_t staleCount();
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "LogMessage.hpp"
+#include "RingBuffer.hpp"
+#include "ThreadPool.hpp"
+
+// LogManager with the sink set fixed at compile time, for deployments whose config
+// never changes. sinks are held by value in a tuple, so the fan-out is a fold over
+// concrete (final) types the compiler can inline instead of a virtual call per sink.
+// any ILogSink implementation works in both managers.
+//
+//   StaticLogManager<ConsoleSinkImpl, FileSinkImpl> logger(2, 1024, ConsoleSinkImpl{}, FileSinkImpl{"out.log"});
+template <typename... Sinks>
+class StaticLogManager
+{
+private:
+    std::tuple<Sinks...> sinks;
+    RingBuffer<LogMessage> messages;
+    std::mutex write_mutex; // one writer at a time keeps sink output ordered
+    std::unique_ptr<ThreadPool> pool; // last: its workers are joined before the sinks go away
+
+    void write_to_sinks(const LogMessage &message)
+    {
+        std::apply([&message](auto &...sink)
+                   { (sink.write(message), ...); },
+                   sinks);
+    }
+
+    void flush_sinks()
+    {
+        std::apply([](auto &...sink)
+                   { (sink.flush(), ...); },
+                   sinks);
+    }
+
+public:
+    StaticLogManager(size_t thread_count, size_t capacity, Sinks... sink)
+        : sinks(std::move(sink)...), messages(capacity), pool(std::make_unique<ThreadPool>(thread_count))
+    {
+    }
+
+    // a full ring is drained by the caller, as in LogManager: nothing is dropped
+    void log(const LogMessage &message)
+    {
+        while (!messages.tryPush(message))
+            write();
+        pool->push_task([this]()
+                        { this->write(); });
+    }
+
+    void log_batch(const std::vector<LogMessage> &batch)
+    {
+        if (batch.empty())
+            return;
+
+        size_t pushed = messages.tryPushBatch(batch);
+        while (pushed < batch.size())
+        {
+            write(); // backpressure: the caller makes room instead of losing the rest
+            pushed += messages.tryPushBatch(batch, pushed);
+        }
+        pool->push_task([this]()
+                        { this->write(); });
+    }
+
+    void write()
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        while (auto maybe_msg = messages.trypop())
+        {
+            maybe_msg->render();
+            write_to_sinks(maybe_msg.value());
+        }
+        flush_sinks();
+    }
+
+    void flush()
+    {
+        write();
+    }
+
+    void write_now(const LogMessage &message)
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (message.deferred)
+        {
+            LogMessage rendered = message;
+            rendered.render();
+            write_to_sinks(rendered);
+            return;
+        }
+        write_to_sinks(message);
+    }
+
+    template <typename Sink>
+    Sink &sink()
+    {
+        return std::get<Sink>(sinks);
+    }
+
+    StaticLogManager &operator<<(const LogMessage &message)
+    {
+        this->log(message);
+        return *this;
+    }
+
+    ~StaticLogManager()
+    {
+        pool.reset();
+        write(); // what the workers did not get to
+    }
+};
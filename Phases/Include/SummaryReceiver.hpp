@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include "LogManager.hpp"
+#include "MetricSummary.hpp"
+
+// central side of edge pre-aggregation: accepts SummarySinkImpl connections, merges
+// the summaries of every node per source and window, and logs each window grace_ms
+// after the first summary for it arrived ("summary" app, same text as the maintenance
+// downsampler). keying on arrival rather than window end leaves the edges' own close
+// delay out of it. a summary for a window already logged is late: it is counted and
+// acknowledged, never logged as a second record for that window.
+// a record is acknowledged to its edge only once its window was logged, and replays
+// of records already merged are recognised by sender id and seq and skipped
+class SummaryReceiver
+{
+private:
+    LogManager &manager;
+    uint16_t port;
+    int64_t grace_ms;
+
+    int listen_fd = -1;
+    std::thread worker;
+    std::atomic<bool> running{false};
+
+    struct Window
+    {
+        MetricSummary summary;
+        int64_t first_arrival_ms;
+    };
+    std::map<std::tuple<int64_t, std::string, std::string>, Window> windows; // start, app, context
+    std::map<std::pair<std::string, std::string>, int64_t> logged_upto; // app, context -> last window start logged
+    size_t received = 0;
+    size_t late = 0;
+
+    struct Sender
+    {
+        uint64_t merged = 0;                           // highest seq merged into windows
+        uint64_t acked = 0;                            // highest seq acknowledged
+        std::deque<std::pair<uint64_t, int64_t>> open; // seq, window start, not logged yet
+    };
+    std::map<uint64_t, Sender> senders;
+
+    void run();
+    void onRecord(Sender &sender, uint64_t seq, std::string_view payload, int64_t now_ms);
+    void emitClosed(int64_t now_ms, bool all);
+    uint64_t ackable(Sender &sender);
+
+public:
+    SummaryReceiver(LogManager &manager, uint16_t port, int64_t grace_ms);
+
+    void start();
+    void stop(); // logs the windows still open
+
+    SummaryReceiver(const SummaryReceiver &) = delete;
+    SummaryReceiver &operator=(const SummaryReceiver &) = delete;
+
+    ~SummaryReceiver();
+};
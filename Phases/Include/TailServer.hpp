@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MessageFilter.hpp"
+
+// live tail for operators: clients connect over TCP (loopback) or a Unix socket, send
+// one filter line and receive the matching records as log lines, e.g.
+//
+//   echo "min_level=Warning context=CPU,GPU min=80" | nc -q -1 127.0.0.1 24100
+//
+// the line is a MessageFilter; a new line on the same connection replaces its filter.
+// subscribers with the same filter share one group, so publish() evaluates each distinct
+// filter once per message and formats a matching message once. output is buffered per
+// subscriber and written every batch_ms; a subscriber whose buffer passes max_buffer is
+// dropped instead of slowing the pipeline down
+class TailServer
+{
+private:
+    struct Subscriber
+    {
+        int fd;
+        std::string in;    // partial filter line
+        std::string out;   // pending output, guarded by mtx
+        std::string group; // filter key, empty until subscribed
+        bool input_closed = false;
+        bool dropped = false;
+    };
+
+    struct Group
+    {
+        MessageFilter filter;
+        std::vector<int> members; // subscriber fds
+    };
+
+    int tcp_fd = -1;
+    int unix_fd = -1;
+    std::string unix_path;
+    size_t max_buffer;
+    int batch_ms;
+
+    std::mutex mtx; // subscribers' out/dropped and groups, shared with publish()
+    std::map<int, Subscriber> subscribers;
+    std::map<std::string, Group> groups;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+
+    void run();
+    void readFilter(Subscriber &subscriber);
+    void subscribe(Subscriber &subscriber, MessageFilter filter);
+    void leaveGroup(Subscriber &subscriber);
+    void flushOutput();
+    void closeSubscriber(int fd);
+
+public:
+    TailServer(uint16_t port, std::string unix_path, size_t max_buffer, int batch_ms);
+    ~TailServer();
+
+    TailServer(const TailServer &) = delete;
+    TailServer &operator=(const TailServer &) = delete;
+
+    void start();
+    void stop();
+
+    // called from the logger's write path, never blocks on a subscriber
+    void publish(const LogMessage &message);
+
+    size_t subscriberCount();
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+// public API of the telemetry_logging library: include this one header
+// and link telemetry_logging (static) or telemetry_logging_shared.
+
+#define TELEMETRY_LOGGING_VERSION_MAJOR 1
+#define TELEMETRY_LOGGING_VERSION_MINOR 0
+
+#include "LogMessage.hpp"
+#include "LogManager.hpp"
+#include "StaticLogManager.hpp"
+#include "ShardedLogManager.hpp"
+#include "LogFormat.hpp"
+#include "BinaryLog.hpp"
+#include "LogProducer.hpp"
+#include "StagingBackend.hpp"
+#include "Formatter.hpp"
+#include "sinks/ILogSink.hpp"
+#include "sinks/ConsoleSinkImpl.hpp"
+#include "sinks/FileSinkImpl.hpp"
+#include "sinks/SegmentedFileSinkImpl.hpp"
+#include "sinks/ArchiveSinkImpl.hpp"
+#include "telemetry/ITelemetrySource.hpp"
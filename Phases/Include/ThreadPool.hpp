@@ -7,6 +7,9 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <cstdio>
+#include <pthread.h>
+#include <sched.h>
 
 class ThreadPool
 {
@@ -41,13 +44,23 @@ private:
     }
 
 public:
-    explicit ThreadPool(size_t thread_count)
+    // cpu >= 0 pins every worker to that core (sharded pipelines)
+    explicit ThreadPool(size_t thread_count, int cpu = -1)
         : stop_flag(false)
     {
         for (size_t i = 0; i < thread_count; ++i)
         {
             workers.emplace_back([this]()
                                  { worker_loop(); });
+
+            if (cpu >= 0)
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                if (pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set) != 0)
+                    std::perror("pthread_setaffinity_np");
+            }
         }
     }
 
@@ -58,6 +71,13 @@ public:
     ThreadPool &operator=(ThreadPool &&) = delete;
 
     ~ThreadPool()
+    {
+        join();
+    }
+
+    // runs the queued tasks, then stops the workers. the pool object stays valid for
+    // tasks that still reach it while they finish
+    void join()
     {
         {
             std::lock_guard<std::mutex> lock(queue_mutex);
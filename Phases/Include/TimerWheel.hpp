@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// hierarchical timer wheel: 4 levels of 64 slots, level n slots span 64^n ticks.
+// arm and cancel are O(1) list splices; advance() touches only the slot of each elapsed
+// tick, and a higher-level slot is cascaded down once each time the level below wraps.
+// timers are handles from add(), expiry past the top level is clamped and re-cascaded
+class TimerWheel
+{
+public:
+    using Handle = uint32_t;
+    static constexpr Handle none = UINT32_MAX;
+
+private:
+    static constexpr int levels = 4;
+    static constexpr int slot_bits = 6;
+    static constexpr uint64_t slots = 1u << slot_bits;
+
+    struct Timer
+    {
+        uint64_t expires = 0; // tick
+        Handle prev = none, next = none;
+        uint32_t slot = UINT32_MAX; // level * slots + index, UINT32_MAX when not armed
+    };
+
+    std::vector<Timer> timers;
+    std::array<Handle, levels * slots> heads;
+    uint64_t now_tick;
+
+    void link(Handle h);
+    void unlink(Handle h);
+    void cascade(int level);
+
+public:
+    explicit TimerWheel(uint64_t start_tick = 0);
+
+    Handle add();
+    size_t size() const { return timers.size(); }
+
+    void arm(Handle h, uint64_t expires_tick); // re-arming moves the timer
+    void cancel(Handle h);
+    bool armed(Handle h) const { return timers[h].slot != UINT32_MAX; }
+
+    uint64_t now() const { return now_tick; }
+
+    // runs the clock to tick, fn(handle) for every timer that expired on the way
+    template <typename Fn>
+    void advance(uint64_t tick, Fn &&fn)
+    {
+        while (now_tick < tick)
+        {
+            ++now_tick;
+            uint64_t index = now_tick & (slots - 1);
+            if (index == 0)
+                cascade(1);
+
+            Handle h;
+            while ((h = heads[index]) != none)
+            {
+                unlink(h);
+                fn(h); // may re-arm h
+            }
+        }
+    }
+};
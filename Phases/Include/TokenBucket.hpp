@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstddef>
+
+// byte-rate limiter: acquire() sleeps until the bucket covers the request.
+// burst is one second worth of rate; rate 0 means unlimited
+class TokenBucket
+{
+private:
+    using clock = std::chrono::steady_clock;
+
+    double rate;   // bytes per second
+    double tokens; // may go negative for a request larger than the burst
+    clock::time_point last;
+
+public:
+    explicit TokenBucket(double bytes_per_second)
+        : rate(bytes_per_second), tokens(bytes_per_second), last(clock::now()) {}
+
+    void acquire(size_t bytes)
+    {
+        if (rate <= 0)
+            return;
+
+        auto now = clock::now();
+        tokens = std::min(rate, tokens + std::chrono::duration<double>(now - last).count() * rate);
+        last = now;
+
+        tokens -= static_cast<double>(bytes);
+        if (tokens < 0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(-tokens / rate));
+    }
+};
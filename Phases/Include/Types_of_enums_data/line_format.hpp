@@ -0,0 +1,9 @@
+#pragma once
+
+// Layout of raw telemetry lines coming from a source
+enum class line_format
+{
+    Single,   // "45.2" -> one value for the configured policy
+    KeyValue, // "cpu=45.2,ram=61.0,gpu=88.1"
+    Csv       // header line "cpu,ram,gpu" then "45.2,61.0,88.1"
+};
\ No newline at end of file
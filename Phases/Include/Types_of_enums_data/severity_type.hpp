@@ -4,5 +4,23 @@ enum class severity_level
 {
     Warning,
     Critical,
-    Info
-};
\ No newline at end of file
+    Info,
+    Debug // only produced by the log<severity_level::Debug> front end
+};
+
+// declaration order is kept for the on-disk index bitmasks, this is the real ordering
+constexpr int severityRank(severity_level level)
+{
+    switch (level)
+    {
+    case severity_level::Debug:
+        return 0;
+    case severity_level::Info:
+        return 1;
+    case severity_level::Warning:
+        return 2;
+    case severity_level::Critical:
+        return 3;
+    }
+    return 0;
+}
@@ -5,5 +5,6 @@ enum class enum_telem_src
 {
     CPU,
     GPU,
-    RAM
+    RAM,
+    IO
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// segmented append-only log of opaque records, each numbered with a sequence number.
+// append() only buffers; commit() writes the whole group with one write() and one
+// fdatasync(), so durability costs one sync per batch, not per record.
+// acknowledge() persists the highest delivered sequence and deletes segments that
+// hold nothing newer. after a crash the torn tail is cut and everything past the
+// last ack is read back for replay.
+//
+//   <dir>/wal-<first seq, 20 digits>.log   records: u32 size, u32 crc, u64 seq, payload
+//   <dir>/acked                            highest acknowledged seq (text)
+class WriteAheadLog
+{
+private:
+    struct Segment
+    {
+        uint64_t first_seq;
+        std::string path;
+        uint64_t bytes; // committed
+    };
+
+    std::string dir;
+    uint64_t segment_bytes;
+    uint64_t max_bytes; // 0 = unbounded; otherwise oldest segments are dropped unacked
+
+    std::vector<Segment> segments; // oldest first, the last one is open for append
+    int fd = -1; // last segment, append only
+    uint64_t total_bytes = 0;
+
+    std::string pending; // appended, not committed yet
+    uint64_t next_seq = 1;
+    uint64_t committed_seq = 0;
+    uint64_t acked_seq = 0;
+
+    // read position, so sequential replay does not rescan a segment per call
+    struct Cursor
+    {
+        size_t segment = 0;
+        uint64_t offset = 0;
+        uint64_t seq = 0; // next seq at offset, 0 = invalid
+    } cursor;
+
+    void recover();
+    uint64_t scanValid(int file, uint64_t first_seq, uint64_t &last_seq) const; // bytes of whole, valid records
+    void openSegment(uint64_t first_seq);
+    void persistAck();
+    void removeSegments();
+
+public:
+    WriteAheadLog(std::string dir, uint64_t segment_bytes, uint64_t max_bytes = 0);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    uint64_t append(std::string_view payload); // returns the record's seq
+    void commit();                             // group commit: write + fdatasync
+
+    void acknowledge(uint64_t seq); // everything <= seq was delivered
+
+    // committed records with seq >= from_seq, up to about max_bytes of payload.
+    // returns the seq after the last record passed to fn
+    uint64_t read(uint64_t from_seq, size_t max_bytes,
+                  const std::function<void(uint64_t seq, std::string_view payload)> &fn);
+
+    uint64_t committedSeq() const { return committed_seq; }
+    uint64_t ackedSeq() const { return acked_seq; }
+    uint64_t sizeBytes() const { return total_bytes + pending.size(); }
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include "coro/EpollExecutor.hpp"
+
+// telemetry sources written as straight-line coroutines on an EpollExecutor
+namespace coro
+{
+    using LineHandler = std::function<void(std::string &)>;
+
+    // setup once, then tick every interval (file and cgroup sources, which never block)
+    Task periodic(EpollExecutor &ex, std::chrono::milliseconds interval, std::function<bool()> setup,
+                  std::function<void()> tick, const std::atomic<bool> &running);
+
+    // newline-delimited TCP stream, woken by socket readiness; reconnects after retry
+    Task socketLines(EpollExecutor &ex, std::string ip, uint16_t port, std::chrono::milliseconds retry,
+                     LineHandler on_line, const std::atomic<bool> &running);
+
+    // read() after every notification (SOME/IP event subscription)
+    Task onEvent(Event &event, std::function<bool(std::string &)> read,
+                 LineHandler on_line, const std::atomic<bool> &running);
+}
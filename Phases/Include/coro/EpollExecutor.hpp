@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <unordered_set>
+#include <vector>
+#include "coro/Task.hpp"
+
+namespace coro
+{
+    // single-threaded scheduler for source coroutines: readiness from epoll, timers
+    // from a min-heap, cross-thread wakeups through an eventfd. thousands of sources
+    // become suspended frames instead of a thread (and a stack) each
+    class EpollExecutor
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+    private:
+        int epoll_fd = -1;
+        int wake_fd = -1; // eventfd, post() from other threads
+
+        using Timer = std::pair<clock::time_point, std::coroutine_handle<>>;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+
+        std::vector<std::coroutine_handle<>> ready;
+        std::unordered_set<int> registered; // fds known to epoll
+        std::unordered_set<void *> tasks;   // live frames, destroyed on shutdown
+
+        std::mutex posted_mtx;
+        std::vector<std::coroutine_handle<>> posted;
+
+        void resume(std::coroutine_handle<> h);
+        void waitFor(int fd, uint32_t events, std::coroutine_handle<> h);
+
+    public:
+        EpollExecutor();
+        ~EpollExecutor();
+
+        EpollExecutor(const EpollExecutor &) = delete;
+        EpollExecutor &operator=(const EpollExecutor &) = delete;
+
+        void spawn(Task task);
+
+        // runs on the calling thread until every task finished or running turns false
+        void run(const std::atomic<bool> &running);
+
+        // resume h on the executor thread, callable from any thread
+        void post(std::coroutine_handle<> h);
+
+        void waitReadable(int fd, std::coroutine_handle<> h);
+        void waitWritable(int fd, std::coroutine_handle<> h); // also a finished non-blocking connect
+        void waitUntil(clock::time_point deadline, std::coroutine_handle<> h);
+        void forget(int fd); // before closing an fd that was awaited
+
+        size_t taskCount() const { return tasks.size(); }
+
+        struct ReadableAwaiter
+        {
+            EpollExecutor &ex;
+            int fd;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ex.waitReadable(fd, h); }
+            void await_resume() const noexcept {}
+        };
+
+        struct WritableAwaiter
+        {
+            EpollExecutor &ex;
+            int fd;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ex.waitWritable(fd, h); }
+            void await_resume() const noexcept {}
+        };
+
+        struct SleepAwaiter
+        {
+            EpollExecutor &ex;
+            clock::time_point deadline;
+            bool await_ready() const noexcept { return deadline <= clock::now(); }
+            void await_suspend(std::coroutine_handle<> h) { ex.waitUntil(deadline, h); }
+            void await_resume() const noexcept {}
+        };
+
+        ReadableAwaiter readable(int fd) { return {*this, fd}; }
+        WritableAwaiter writable(int fd) { return {*this, fd}; }
+        SleepAwaiter sleep_for(std::chrono::milliseconds duration) { return {*this, clock::now() + duration}; }
+    };
+
+    // one-shot notification from another thread (SOME/IP event callbacks), auto-resets
+    class Event
+    {
+    private:
+        EpollExecutor &ex;
+        std::mutex mtx;
+        bool signaled = false;
+        std::coroutine_handle<> waiter;
+
+    public:
+        explicit Event(EpollExecutor &ex) : ex(ex) {}
+
+        void set();
+
+        bool await_ready();
+        bool await_suspend(std::coroutine_handle<> h);
+        void await_resume() const noexcept {}
+    };
+}
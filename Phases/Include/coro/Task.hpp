@@ -0,0 +1,43 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace coro
+{
+    // top-level coroutine run by EpollExecutor: starts suspended, the executor resumes it
+    // and destroys the frame once it finishes (or when the executor shuts down)
+    class Task
+    {
+    public:
+        struct promise_type
+        {
+            std::exception_ptr exception;
+
+            Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { exception = std::current_exception(); }
+        };
+
+        using handle = std::coroutine_handle<promise_type>;
+
+        explicit Task(handle h) : h(h) {}
+        Task(Task &&other) noexcept : h(std::exchange(other.h, {})) {}
+        Task &operator=(Task &&) = delete;
+        Task(const Task &) = delete;
+
+        handle release() { return std::exchange(h, {}); }
+
+        ~Task()
+        {
+            if (h)
+                h.destroy();
+        }
+
+    private:
+        handle h;
+    };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "nlohmann_json/json.hpp"
+#include "pipeline/Stage.hpp"
+#include "sinks/ILogSink.hpp"
+#include "ThreadPool.hpp"
+
+// DAG of named stages described in config, e.g.
+//
+//   { "name": "in",     "kind": "source", "type": "file", "path": "...", "to": ["parse"] },
+//   { "name": "parse",  "kind": "parse", "format": "kv", "policy": "cpu", "to": ["policy"] },
+//   { "name": "policy", "kind": "policy", "workers": 2, "to": ["route"] },
+//   { "name": "route",  "kind": "route", "rules": [{ "filter": "min_level=Warning", "to": ["alerts"] }],
+//                       "default": ["main"] },
+//   { "name": "alerts", "kind": "sink", "console": { "enabled": true } },
+//   { "name": "main",   "kind": "sink", "files": [{ "enabled": true, "path": "logs/main.log" }] }
+//
+// kinds: source, parse, policy, dedup, aggregate, route, sink. every edge is its own
+// bounded queue: lock-free SPSC when both ends run on one worker at a time, a locked
+// ring when either end runs with "workers" > 1. stages run as tasks on one thread pool,
+// scheduled when input arrives. nothing is dropped on a full edge: a stage parks the
+// outputs it could not send and takes no more input until the consumer makes room, so
+// its own input fills up and the pressure travels back to the source, whose push()
+// waits. pool workers never block. drops (a source pushing during stop) are reported
+// every 10 s. sources are not run here: the owner reads them and calls push()
+class Pipeline
+{
+public:
+    // sink set of a "sink" stage, built by the owner from the stage's config
+    using SinkFactory = std::function<std::vector<std::unique_ptr<ILogSink>>(const nlohmann::json &stage)>;
+
+    struct Source
+    {
+        std::string name;
+        nlohmann::json config;
+        size_t node;
+    };
+
+    struct Queue; // one bounded queue per edge, defined with its variants in Pipeline.cpp
+
+private:
+    struct Edge;
+    struct Node;
+
+    // what forward() does on a full edge
+    enum class Push
+    {
+        Park,   // pool worker: hand the rest back to the caller
+        Wait,   // source thread: retry until the consumer drained some
+        Inline, // final pass of stop(): drain the consumer on this thread
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::vector<std::unique_ptr<Edge>> edges;
+    std::vector<size_t> order; // topological
+    std::vector<Source> source_list;
+    size_t batch = 256;        // items per input edge before moving on
+
+    std::unique_ptr<ThreadPool> pool;
+    std::atomic<bool> stopping{false};
+    std::atomic<int64_t> next_drop_report{0};
+
+    void build(const nlohmann::json &stages, size_t capacity, const SinkFactory &makeSinks);
+    void schedule(Node &node);
+    bool tryAcquire(Node &node);
+    bool hasWork(const Node &node) const;
+    void runNode(Node &node);
+    size_t drain(Node &node, StageOutput &out, size_t limit, Push mode = Push::Park);
+    // false: out keeps what a full edge refused
+    bool forward(Node &node, StageOutput &out, Push mode = Push::Park);
+    void park(Node &node, StageOutput &out);
+    bool unpark(Node &node, Push mode); // false while still blocked
+    void reportDrops(); // drops since the last report
+
+public:
+    Pipeline(const nlohmann::json &config, const SinkFactory &makeSinks);
+    ~Pipeline();
+
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+
+    const std::vector<Source> &sources() const { return source_list; }
+
+    // from the thread reading source_node: one producer per source. waits while the
+    // first stage's queue is full
+    void push(size_t source_node, PipelineItem item);
+
+    // periodic clock for windows and cleanup (and drop reports), from any thread
+    void tick();
+
+    // after the sources stopped: drain every stage in order, finish them, flush sinks
+    void stop();
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include "LogMessage.hpp"
+
+// what flows along the edges of a Pipeline. a stage handles the kinds it knows and
+// passes the others on unchanged
+
+// one line as read by a source
+struct RawLine
+{
+    std::string text;
+};
+
+// one metric split out of a line, not classified yet
+struct Metric
+{
+    std::string policy; // "cpu", "ram", "gpu", "io"
+    std::string value;
+    std::optional<int64_t> event_time_ms;
+    std::string app_name; // set for derived metrics, empty keeps the policy's
+};
+
+using PipelineItem = std::variant<RawLine, Metric, LogMessage>;
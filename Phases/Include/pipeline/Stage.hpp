@@ -0,0 +1,36 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "pipeline/PipelineItem.hpp"
+
+// items a stage produced, each for one output port (index into the stage's "to" list)
+// or for all of them
+struct StageOutput
+{
+    static constexpr int all_ports = -1;
+
+    std::vector<std::pair<int, PipelineItem>> items;
+
+    void push(PipelineItem item, int port = all_ports) { items.emplace_back(port, std::move(item)); }
+};
+
+// one processing step of a Pipeline. a stage runs on one worker at a time unless it
+// reports parallelSafe(), so stateful stages need no locking
+class Stage
+{
+public:
+    virtual ~Stage() = default;
+
+    virtual void process(PipelineItem &&item, StageOutput &out) = 0;
+
+    // periodic call from the pipeline clock (window closing, cleanup)
+    virtual void tick(int64_t, StageOutput &) {}
+    // after each drained batch (sinks flush here)
+    virtual void endBatch() {}
+    // last call on shutdown, emit whatever is still buffered
+    virtual void finish(StageOutput &) {}
+
+    // no state between items, may run on several workers at once
+    virtual bool parallelSafe() const { return false; }
+};
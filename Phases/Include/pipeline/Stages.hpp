@@ -0,0 +1,108 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "pipeline/Stage.hpp"
+#include "DerivedMetrics.hpp"
+#include "LineParser.hpp"
+#include "MessageFilter.hpp"
+#include "MetricSummary.hpp"
+#include "sinks/ILogSink.hpp"
+
+// "parse": RawLine -> Metric per field (single, kv or csv lines), plus one per
+// "derived" expression computed from the line's fields
+class ParseStage final : public Stage
+{
+private:
+    LineParser parser;
+    std::optional<DerivedMetrics> derived;
+
+public:
+    ParseStage(line_format format, std::string default_policy, std::optional<DerivedMetrics> derived = std::nullopt)
+        : parser(format, std::move(default_policy)), derived(std::move(derived))
+    {
+    }
+    void process(PipelineItem &&item, StageOutput &out) override;
+};
+
+// "policy": Metric -> LogMessage through the named policy's Formatter
+class PolicyStage final : public Stage
+{
+public:
+    void process(PipelineItem &&item, StageOutput &out) override;
+    bool parallelSafe() const override { return true; }
+};
+
+// "dedup": drops a message whose app, context and text repeat within window_ms
+class DedupStage final : public Stage
+{
+private:
+    int64_t window_ms;
+    std::unordered_map<std::string, int64_t> last_seen; // key -> event time of the last one kept
+    std::string key;
+
+public:
+    explicit DedupStage(int64_t window_ms) : window_ms(window_ms) {}
+    void process(PipelineItem &&item, StageOutput &out) override;
+    void tick(int64_t now_ms, StageOutput &out) override;
+};
+
+// "aggregate": values folded into per-source MetricSummary windows, one "summary"
+// message per closed window. messages without a value pass through
+class AggregateStage final : public Stage
+{
+private:
+    int64_t window_ms;
+    bool pass_through;
+    std::map<std::tuple<std::string, std::string, int64_t>, MetricSummary> open; // app, context, window start
+
+    void close(int64_t now_ms, bool all, StageOutput &out);
+
+public:
+    AggregateStage(int64_t window_ms, bool pass_through);
+    void process(PipelineItem &&item, StageOutput &out) override;
+    void tick(int64_t now_ms, StageOutput &out) override;
+    void finish(StageOutput &out) override;
+};
+
+// "route": the first rule whose filter matches picks the output ports, no match goes
+// to the default ports
+class RouteStage final : public Stage
+{
+public:
+    struct Rule
+    {
+        MessageFilter filter;
+        std::vector<int> ports;
+    };
+
+private:
+    std::vector<Rule> rules;
+    std::vector<int> default_ports;
+    bool needs_value = false;
+
+    static void send(PipelineItem &&item, const std::vector<int> &ports, StageOutput &out);
+
+public:
+    RouteStage(std::vector<Rule> rules, std::vector<int> default_ports);
+    void process(PipelineItem &&item, StageOutput &out) override;
+    bool parallelSafe() const override { return true; }
+};
+
+// "sink": terminal stage writing LogMessages to its own sink set
+class SinkStage final : public Stage
+{
+private:
+    std::vector<std::unique_ptr<ILogSink>> sinks;
+
+public:
+    explicit SinkStage(std::vector<std::unique_ptr<ILogSink>> sinks) : sinks(std::move(sinks)) {}
+    void process(PipelineItem &&item, StageOutput &out) override;
+    void endBatch() override;
+    void finish(StageOutput &out) override;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string_view>
+
+#include "Types_of_enums_data/severity_type.hpp"
+#include "Types_of_enums_data/telemetry_source.hpp"
+
+struct IO_policy
+{
+    static constexpr enum_telem_src context = enum_telem_src::IO;
+    static constexpr std::string_view unit = "MB/s";
+
+    static constexpr float Warning = 100.0f;
+    static constexpr float Critical = 200.0f;
+
+    static constexpr severity_level inferSeverity(float value) noexcept
+    {
+        return (value >= Critical) ? severity_level::Critical : (value >= Warning) ? severity_level::Warning
+                                                                                   : severity_level::Info;
+    }
+};
@@ -18,8 +18,11 @@ private:
 
 public:
     SafeFile(const string &file_path);
+    SafeFile(const string &file_path, int flags);
     void write(const string &str);
     bool readLine(string &out);
+    ssize_t readAt(char *buf, size_t len, off_t offset); // pread, keeps the fd open for re-sampling
+    bool isOpen() const { return fd != -1; }
 
     // move
     SafeFile(SafeFile &&other) noexcept;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// mmap of a whole file, unmapped on destruction.
+// read-only by default; the sized constructor maps read/write (MAP_SHARED)
+class SafeMappedFile
+{
+public:
+    using string = std::string;
+
+private:
+    string path;
+    char *data = nullptr;
+    size_t length = 0;
+
+public:
+    explicit SafeMappedFile(const string &file_path);
+    // creates the file if needed and grows it to size bytes (new bytes read as zero)
+    SafeMappedFile(const string &file_path, size_t size);
+
+    std::string_view view() const { return {data, length}; }
+    char *writable() { return data; }
+    size_t size() const { return length; }
+    void sync(); // msync(MS_ASYNC)
+
+    // move
+    SafeMappedFile(SafeMappedFile &&other) noexcept;
+    SafeMappedFile &operator=(SafeMappedFile &&other) noexcept;
+
+    // copy
+    SafeMappedFile(const SafeMappedFile &) = delete;
+    SafeMappedFile &operator=(const SafeMappedFile &) = delete;
+
+    ~SafeMappedFile();
+};
@@ -20,10 +20,14 @@ private:
     uint16_t portNumber;
 
 public:
-    SafeSocket(const string &ip, uint16_t port);
+    // nonblocking: the connect may still be in progress, wait until writable and check connectError()
+    SafeSocket(const string &ip, uint16_t port, bool nonblocking = false);
+
+    int connectError() const; // SO_ERROR, 0 once connected
 
     bool sendString(const string &message);
     bool receiveLine(string &out); // read until '\n'
+    int fd() const { return sockfd; }
 
     // move semantics
     SafeSocket(SafeSocket &&other) noexcept;
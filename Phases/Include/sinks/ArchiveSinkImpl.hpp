@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ILogSink.hpp"
+#include "MetricArchive.hpp"
+#include <map>
+#include <memory>
+
+// feeds the value of every message into a MetricArchive per source,
+// "<dir>/<context>.rrd" or "<dir>/<app>.<context>.rrd" when the app differs (cgroups)
+class ArchiveSinkImpl final : public ILogSink
+{
+private:
+    std::string dir;
+    std::vector<MetricArchive::Resolution> layout;
+    std::map<std::string, std::unique_ptr<MetricArchive>> archives;
+
+    MetricArchive *archiveFor(const LogMessage &message);
+
+public:
+    void write(const LogMessage &message) override;
+    void flush() override;
+    ArchiveSinkImpl(const std::string &dir, std::vector<MetricArchive::Resolution> layout);
+    ArchiveSinkImpl(ArchiveSinkImpl &&) = default;
+    virtual ~ArchiveSinkImpl() = default;
+
+    static std::string archiveName(const std::string &app, const std::string &context);
+};
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "ILogSink.hpp"
+#include <sstream>
 
-class ConsoleSinkImpl : public ILogSink
+class ConsoleSinkImpl final : public ILogSink
 {
 private:
+    std::ostringstream line; // whole line in one write, shards share stdout
 public:
     void write(const LogMessage &message) override;
+    void flush() override;
     ConsoleSinkImpl() = default;
+    ConsoleSinkImpl(ConsoleSinkImpl &&) = default; // held by value in StaticLogManager
     virtual ~ConsoleSinkImpl() = default;
 };
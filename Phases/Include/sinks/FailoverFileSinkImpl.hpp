@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ILogSink.hpp"
+#include "LogIndex.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct FailoverConfig
+{
+    std::string primary_path;
+    std::string backup_path;
+    size_t index_block_lines = 0;     // sidecar index of the primary, 0 = none
+    std::chrono::milliseconds latency{200}; // a flush slower than this counts as slow
+    int slow_flushes = 3;             // consecutive slow flushes before switching
+    std::chrono::milliseconds probe_interval{1000};
+    bool resync = true;               // copy what went to the backup into the primary on return
+};
+
+// one log kept in the primary file, written to the backup only while the primary is
+// unhealthy: a write error, or slow_flushes flushes in a row over the latency limit.
+// lines are formatted once into a batch that reaches the file in one write per flush,
+// so a failed batch is truncated off the primary and written to the backup whole.
+// a probe thread checks the primary's directory while failed over; the next flush
+// after a good probe reopens the primary and starts the resync: batches keep going to
+// the backup, and every flush also copies a bounded step of the backup's lines since the
+// switch into the primary. once the copy catches up with the backup it moves back
+class FailoverFileSinkImpl final : public ILogSink
+{
+private:
+    struct Target
+    {
+        std::string path;
+        int fd = -1;
+        uint64_t size = 0;
+    };
+
+    // index facts of a batched line, added once the line is in the primary
+    struct PendingLine
+    {
+        int64_t time_ms;
+        uint32_t severity_bit;
+        uint32_t context_bit;
+        uint64_t end; // in the batch
+    };
+
+    FailoverConfig cfg;
+    Target primary, backup;
+    std::optional<LogIndexWriter> index;
+
+    std::ostringstream batch;
+    std::vector<PendingLine> pending;
+
+    bool on_backup = false;
+    int slow = 0;
+    uint64_t backup_mark = 0; // backup size when the primary was left
+
+    bool resyncing = false;   // primary reopened, backup lines still being copied
+    uint64_t resync_pos = 0;  // next backup byte to copy, always at a line start
+    size_t resync_lines = 0;
+
+    std::thread prober;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool failed = false;      // guarded by mtx, wakes the prober
+    bool stopping = false;
+    std::atomic<bool> primary_ok{false};
+
+    static bool open(Target &target, bool append);
+    static bool writeAll(Target &target, const std::string &text);
+
+    void failover(const std::string &reason, const std::string &text);
+    void failback();
+    bool resyncStep();
+    void probe();
+
+public:
+    void write(const LogMessage &message) override;
+    void flush() override;
+
+    explicit FailoverFileSinkImpl(FailoverConfig cfg);
+    ~FailoverFileSinkImpl() override;
+};
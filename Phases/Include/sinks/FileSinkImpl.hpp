@@ -1,15 +1,27 @@
 #pragma once
 
 #include "ILogSink.hpp"
+#include "LogIndex.hpp"
 #include "fstream"
+#include <sstream>
+#include <optional>
 
-class FileSinkImpl : public ILogSink
+class FileSinkImpl final : public ILogSink
 {
 private:
     std::ofstream file;
 
+    // sidecar block index, see LogIndex.hpp
+    std::optional<LogIndexWriter> index;
+    std::ostringstream line;
+    uint64_t offset = 0;
+
 public:
     void write(const LogMessage &message) override;
-    FileSinkImpl(const std::string &filename);
+    void flush() override;
+    // index_block_lines > 0 also writes "<filename>.idx" with one entry per that many lines.
+    // append keeps existing content (segments reopened after a restart)
+    FileSinkImpl(const std::string &filename, size_t index_block_lines = 0, bool append = false);
+    FileSinkImpl(FileSinkImpl &&) = default; // held by value in StaticLogManager
     virtual ~FileSinkImpl() = default;
 };
\ No newline at end of file
@@ -6,6 +6,7 @@ class ILogSink
 private:
 public:
     virtual void write(const LogMessage &message) = 0;
+    virtual void flush() {} // end of a write batch
     ILogSink() = default;
     virtual ~ILogSink() = default;
 };
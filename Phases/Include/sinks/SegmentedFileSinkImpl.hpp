@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ILogSink.hpp"
+#include "FileSinkImpl.hpp"
+#include <memory>
+#include <limits>
+
+// FileSinkImpl split into one file per wall-clock period, see LogSegments.hpp for naming.
+// retention deletes whole old segments. a segment holds whatever event times arrived
+// during its period; its index has their range, clamped to a minute ahead of the clock
+class SegmentedFileSinkImpl final : public ILogSink
+{
+private:
+    std::string dir;
+    std::string prefix;
+    int64_t period_ms;
+    size_t index_block_lines;
+    int64_t retention_ms; // 0 keeps everything
+
+    int64_t current_start = std::numeric_limits<int64_t>::min();
+    std::string current_path;
+    std::unique_ptr<FileSinkImpl> current;
+
+    void rotate(int64_t start_ms);
+
+public:
+    void write(const LogMessage &message) override;
+    void flush() override;
+    SegmentedFileSinkImpl(const std::string &dir, const std::string &prefix, int64_t period_ms,
+                          size_t index_block_lines, int64_t retention_ms);
+    SegmentedFileSinkImpl(SegmentedFileSinkImpl &&) = default;
+    virtual ~SegmentedFileSinkImpl() = default;
+};
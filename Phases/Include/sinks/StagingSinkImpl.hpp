@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ILogSink.hpp"
+#include "StagingBackend.hpp"
+
+// hands messages to a StagingBackend, which merges them into another LogManager.
+// used as the only sink of a shard when shard outputs are merged into one stream
+class StagingSinkImpl final : public ILogSink
+{
+private:
+    StagingBackend &backend;
+
+public:
+    void write(const LogMessage &message) override;
+    explicit StagingSinkImpl(StagingBackend &backend) : backend(backend) {}
+    virtual ~StagingSinkImpl() = default;
+};
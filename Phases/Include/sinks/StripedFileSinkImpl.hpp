@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ILogSink.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct StripeConfig
+{
+    std::vector<std::string> dirs; // one stripe per directory, ideally one per disk
+    std::string name = "output";
+    bool by_source = false;        // false: batches round-robin; true: a source always lands on one stripe
+    size_t batch_bytes = 256 << 10;
+    size_t queue_batches = 16;     // per stripe; a full queue blocks the caller
+};
+
+// one log spread over several directories, see LogStripes.hpp for the layout.
+// lines are formatted into a batch per stripe; a full batch (or flush) is recorded in
+// the manifest and handed to that stripe's writer thread, so each device gets its own
+// sequential writer and the caller never waits on a disk unless a queue is full
+class StripedFileSinkImpl final : public ILogSink
+{
+private:
+    struct Stripe
+    {
+        std::string path;
+        int fd = -1;
+        uint64_t planned = 0; // bytes handed to the writer so far
+
+        std::ostringstream open; // batch being filled
+        int64_t min_time_ms = 0;
+        int64_t max_time_ms = 0;
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<std::pair<uint64_t, std::string>> queue; // offset, batch
+        bool stopping = false;
+        std::thread writer;
+        std::atomic<uint64_t> failed_batches{0};
+    };
+
+    StripeConfig cfg;
+    std::vector<std::unique_ptr<Stripe>> stripes;
+    std::ofstream manifest;
+    uint64_t seq = 0;
+    size_t next = 0; // round-robin stripe
+
+    void cut(size_t index);
+    void run(Stripe &stripe);
+
+public:
+    void write(const LogMessage &message) override;
+    void flush() override;
+
+    explicit StripedFileSinkImpl(StripeConfig cfg);
+    ~StripedFileSinkImpl() override;
+};
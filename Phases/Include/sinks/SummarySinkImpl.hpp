@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ILogSink.hpp"
+#include "MetricSummary.hpp"
+#include "WriteAheadLog.hpp"
+#include "safe/SafeSocket.hpp"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// edge side of pre-aggregation: folds every value into a per-source, per-window
+// MetricSummary and ships closed windows to the central instance over TCP.
+// closed windows go through a write-ahead log first and stay there until central
+// acknowledges them, so a crash, restart or lost connection replays instead of losing.
+// the logger thread only appends and commits; connecting, sending and reading acks
+// happen on the sink's own sender thread
+class SummarySinkImpl final : public ILogSink
+{
+private:
+    std::string central_ip;
+    uint16_t central_port;
+    int64_t window_ms;
+
+    std::map<std::tuple<std::string, std::string, int64_t>, MetricSummary> open; // app, context, window start
+
+    std::unique_ptr<WriteAheadLog> wal;
+    std::mutex wal_mtx; // logger thread appends and commits, the sender reads and acknowledges
+    uint64_t sender_id; // lets central drop replays it already merged
+
+    // sender thread only
+    std::optional<SafeSocket> sock;
+    uint64_t next_send = 0; // next WAL seq to put on the current connection
+    std::string ack_buffer;
+    int64_t next_connect_ms = 0;
+
+    std::thread sender;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool committed = false; // new records since the sender last looked
+    bool stopping = false;
+
+    void closeWindows(int64_t now_ms, bool all);
+    void run();
+    bool send(); // true when it stopped at the per-pass limit with more to send
+    bool connect();
+    void readAcks(int timeout_ms);
+    uint64_t unacked();
+
+public:
+    void write(const LogMessage &message) override;
+    void flush() override;
+    SummarySinkImpl(std::string central_ip, uint16_t central_port, int64_t window_ms,
+                    const std::string &wal_dir, uint64_t wal_segment_bytes, uint64_t wal_max_bytes);
+    virtual ~SummarySinkImpl();
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ILogSink.hpp"
+#include "TailServer.hpp"
+#include <memory>
+
+// feeds every message to the live-tail server; shards each get one, all sharing the server
+class TailSinkImpl final : public ILogSink
+{
+private:
+    std::shared_ptr<TailServer> server;
+
+public:
+    void write(const LogMessage &message) override;
+    explicit TailSinkImpl(std::shared_ptr<TailServer> server) : server(std::move(server)) {}
+    virtual ~TailSinkImpl() = default;
+};
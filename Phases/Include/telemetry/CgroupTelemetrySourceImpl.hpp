@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+
+#include "telemetry/ITelemetrySource.hpp"
+#include "safe/SafeFile.hpp"
+
+// samples cgroup v2 controllers for every cgroup under root with one thread.
+// each readSource() line is "<cgroup> <cpu|ram|io> <value>"
+class CgroupTelemetrySrc : public ITelemetrySource
+{
+    using string = std::string;
+
+private:
+    struct CgroupFiles
+    {
+        // fds stay open for the cgroup lifetime, every sample is a pread at offset 0
+        std::optional<SafeFile> cpu_stat;
+        std::optional<SafeFile> memory_current;
+        std::optional<SafeFile> memory_stat;
+        std::optional<SafeFile> memory_max;
+        std::optional<SafeFile> io_stat;
+
+        uint64_t last_cpu_usec = 0;
+        uint64_t last_io_bytes = 0;
+        bool primed = false;
+    };
+
+    string root;
+    int max_depth;
+    int inotify_fd = -1;
+
+    std::unordered_map<string, CgroupFiles> cgroups; // relative path -> files
+    std::unordered_map<int, string> watches;         // inotify wd -> relative path
+    std::deque<string> pending;
+    std::vector<char> buffer;
+
+    std::chrono::steady_clock::time_point last_sample;
+    uint64_t host_memory_bytes;
+    long online_cpus;
+
+    void discover(const string &relative, int depth);
+    void addCgroup(const string &relative);
+    void removeCgroup(const string &relative);
+    void drainInotify();
+    std::optional<std::string_view> readFile(std::optional<SafeFile> &file); // nullopt when not open or the read failed
+
+public:
+    CgroupTelemetrySrc(string root, int max_depth);
+    bool openSource() override;
+    bool readSource(string &out) override;
+
+    // one batched pass over all cgroups, queues the lines returned by readSource()
+    bool sample();
+
+    size_t cgroupCount() const { return cgroups.size(); }
+
+    CgroupTelemetrySrc(const CgroupTelemetrySrc &) = delete;
+    CgroupTelemetrySrc &operator=(const CgroupTelemetrySrc &) = delete;
+
+    ~CgroupTelemetrySrc();
+};
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <mutex>
 #include <string>
+#include <functional>
 
 #include <CommonAPI/CommonAPI.hpp>
 #include "ITelemetrySource.hpp"
@@ -21,6 +22,7 @@ private:
     std::mutex data_mutex;
     float last_usage;
     std::atomic<bool> has_new_data;
+    std::function<void()> notify; // called from the CommonAPI thread on every event, under data_mutex
 
 public:
     // Singleton access
@@ -28,6 +30,11 @@ public:
 
     bool start();
 
+    // event-driven use (coroutine executor): notify on each event, then readEvent.
+    // nullptr detaches; once it returns the old callback is not running and never runs again
+    void setNotify(std::function<void()> callback);
+    bool readEvent(std::string &out);
+
     // ITelemetrySource
     bool openSource() override;
     bool readSource(std::string &out) override;
@@ -0,0 +1,225 @@
+#include "BinaryLog.hpp"
+
+namespace
+{
+    struct Registry
+    {
+        std::mutex mtx;
+        std::deque<BinaryLog::Descriptor> descriptors; // index is the id
+        std::vector<std::shared_ptr<BinaryLog::StagingBuffer>> buffers;
+        size_t buffer_bytes = 1 << 20;
+    };
+
+    Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    // retires the thread's buffer on thread exit, the backend frees it once drained
+    struct LocalBuffer
+    {
+        std::shared_ptr<BinaryLog::StagingBuffer> buffer;
+
+        LocalBuffer()
+        {
+            auto &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mtx);
+            buffer = std::make_shared<BinaryLog::StagingBuffer>(reg.buffer_bytes);
+            reg.buffers.push_back(buffer);
+        }
+
+        ~LocalBuffer()
+        {
+            buffer->retire();
+        }
+    };
+
+    template <typename T>
+    T load(const char *&in)
+    {
+        T value;
+        std::memcpy(&value, in, sizeof(value));
+        in += sizeof(value);
+        return value;
+    }
+}
+
+uint32_t BinaryLog::registerDescriptor(Descriptor descriptor)
+{
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    reg.descriptors.push_back(std::move(descriptor));
+    return static_cast<uint32_t>(reg.descriptors.size() - 1);
+}
+
+void BinaryLog::setBufferSize(size_t bytes)
+{
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    reg.buffer_bytes = bytes;
+}
+
+BinaryLog::StagingBuffer &BinaryLog::localBuffer()
+{
+    thread_local LocalBuffer local;
+    return *local.buffer;
+}
+
+BinaryLog::StagingBuffer::StagingBuffer(size_t capacity)
+    : storage(std::max<size_t>((capacity + 7) & ~size_t{7}, 4096))
+{
+}
+
+char *BinaryLog::StagingBuffer::reserve(size_t size)
+{
+    size_t capacity = storage.size();
+    uint64_t pos = head.load(std::memory_order_relaxed);
+    size_t offset = pos % capacity;
+
+    // a record never wraps, the rest of the ring is skipped instead
+    uint64_t skip = offset + size > capacity ? capacity - offset : 0;
+    if (pos + skip + size - cached_tail > capacity)
+    {
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (pos + skip + size - cached_tail > capacity)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    if (skip)
+        std::memcpy(storage.data() + offset, &wrap_marker, sizeof(wrap_marker));
+    pending_skip = skip;
+    return storage.data() + (pos + skip) % capacity;
+}
+
+void BinaryLog::StagingBuffer::commit(size_t size)
+{
+    head.store(head.load(std::memory_order_relaxed) + pending_skip + size, std::memory_order_release);
+}
+
+BinaryLogBackend::BinaryLogBackend(LogManager &manager, std::chrono::milliseconds poll_interval)
+    : manager(manager), poll_interval(poll_interval)
+{
+}
+
+BinaryLogBackend::~BinaryLogBackend()
+{
+    stop();
+}
+
+void BinaryLogBackend::start()
+{
+    worker = std::thread([this]()
+                         { run(); });
+}
+
+void BinaryLogBackend::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop_flag = true;
+    }
+    cv.notify_all();
+    if (worker.joinable())
+        worker.join();
+    poll();
+}
+
+void BinaryLogBackend::run()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stop_flag)
+    {
+        lock.unlock();
+        size_t records = poll();
+        lock.lock();
+
+        // keep draining while producers are busy
+        if (records == 0)
+            cv.wait_for(lock, poll_interval, [this]()
+                        { return stop_flag; });
+    }
+}
+
+size_t BinaryLogBackend::poll()
+{
+    auto &reg = registry();
+    std::vector<std::shared_ptr<BinaryLog::StagingBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        buffers = reg.buffers;
+    }
+
+    size_t records = 0;
+    uint64_t dropped = 0;
+    for (auto &buffer : buffers)
+    {
+        bool retired = buffer->isRetired(); // before draining, so nothing committed after is lost
+        records += buffer->drain([this](const BinaryLog::RecordHeader &header, const char *payload)
+                                 { batch.push_back(decode(header, payload)); });
+        dropped += buffer->takeDropped();
+
+        if (retired)
+        {
+            std::lock_guard<std::mutex> lock(reg.mtx);
+            reg.buffers.erase(std::remove(reg.buffers.begin(), reg.buffers.end(), buffer), reg.buffers.end());
+        }
+    }
+
+    if (dropped > 0)
+        std::cout << "[BinaryLog] staging buffer full, " << dropped << " records dropped\n";
+
+    manager.log_batch(batch);
+    batch.clear();
+    return records;
+}
+
+LogMessage BinaryLogBackend::decode(const BinaryLog::RecordHeader &header, const char *payload)
+{
+    const BinaryLog::Descriptor *descriptor;
+    {
+        // deque: the entry does not move when other call sites register
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        descriptor = &reg.descriptors[header.id];
+    }
+
+    uint32_t context_length = load<uint32_t>(payload);
+    std::string context(payload, context_length);
+    payload += context_length;
+
+    std::ostringstream os;
+    size_t pos = 0;
+    for (auto type : descriptor->args)
+    {
+        pos = LogFormat::writeLiteral(os, descriptor->format, pos);
+        switch (type)
+        {
+        case BinaryLog::ArgType::Int:
+            os << load<int64_t>(payload);
+            break;
+        case BinaryLog::ArgType::UInt:
+            os << load<uint64_t>(payload);
+            break;
+        case BinaryLog::ArgType::Float:
+            os << load<double>(payload);
+            break;
+        case BinaryLog::ArgType::Str:
+        {
+            uint32_t length = load<uint32_t>(payload);
+            os << std::string_view(payload, length);
+            payload += length;
+            break;
+        }
+        }
+    }
+    LogFormat::writeLiteral(os, descriptor->format, pos);
+
+    int64_t event_ms = header.time_ns / 1000000;
+    LogMessage msg{"app", context, os.str(), descriptor->level, formatTimeStamp(event_ms)};
+    msg.event_time_ms = event_ms;
+    return msg;
+}
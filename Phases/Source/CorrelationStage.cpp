@@ -0,0 +1,90 @@
+#include "CorrelationStage.hpp"
+#include <algorithm>
+
+CorrelationStage::TimeWindow::TimeWindow(size_t capacity)
+    : times(std::max<size_t>(capacity, 1))
+{
+}
+
+void CorrelationStage::TimeWindow::push(int64_t time)
+{
+    if (count > 0)
+        time = std::max(time, times[(head + count - 1) % times.size()]); // stays sorted
+    if (count == times.size())
+    {
+        head = (head + 1) % times.size();
+        --count;
+    }
+    times[(head + count) % times.size()] = time;
+    ++count;
+}
+
+void CorrelationStage::TimeWindow::evictBefore(int64_t time)
+{
+    while (count > 0 && times[head] < time)
+    {
+        head = (head + 1) % times.size();
+        --count;
+    }
+}
+
+void CorrelationStage::addRule(CorrelationRule rule, size_t window_capacity)
+{
+    window_capacity = std::max(window_capacity, rule.min_count);
+
+    RuleState state{std::move(rule), {}};
+    state.windows.assign(state.rule.contexts.size(), TimeWindow(window_capacity));
+    rules.push_back(std::move(state));
+}
+
+void CorrelationStage::onMessage(const LogMessage &message, std::vector<LogMessage> &out)
+{
+    for (auto &state : rules)
+    {
+        if (message.level != state.rule.level)
+            continue;
+
+        auto it = std::find(state.rule.contexts.begin(), state.rule.contexts.end(), message.context);
+        if (it == state.rule.contexts.end())
+            continue;
+
+        int64_t now = message.event_time_ms;
+        state.newest = std::max(state.newest, now);
+        if (now < state.newest - state.rule.window_ms)
+            continue; // too far behind the newest event to correlate
+        state.windows[it - state.rule.contexts.begin()].push(now);
+
+        // what is left after evicting lies within window_ms of the newest event
+        bool complete = true;
+        for (auto &window : state.windows)
+        {
+            window.evictBefore(state.newest - state.rule.window_ms);
+            if (window.size() < state.rule.min_count)
+                complete = false;
+        }
+
+        if (!complete)
+            continue;
+
+        out.push_back(composite(state, message));
+
+        // start over so one burst reports once
+        for (auto &window : state.windows)
+            window.clear();
+    }
+}
+
+LogMessage CorrelationStage::composite(const RuleState &state, const LogMessage &trigger)
+{
+    std::string joined;
+    for (const auto &context : state.rule.contexts)
+        joined += (joined.empty() ? "" : "+") + context;
+
+    std::string text = state.rule.name + ": " + joined + " " +
+                       std::string(magic_enum::enum_name(state.rule.level)) +
+                       " within " + std::to_string(state.rule.window_ms) + "ms";
+
+    LogMessage msg{"correlation", joined, text, state.rule.level, trigger.time};
+    msg.event_time_ms = trigger.event_time_ms;
+    return msg;
+}
@@ -0,0 +1,45 @@
+#include "DeliveryFrame.hpp"
+
+#include <cstring>
+
+namespace
+{
+    constexpr size_t header_size = sizeof(uint32_t) + sizeof(uint64_t); // type + value
+    constexpr uint32_t max_frame = 1 << 24;
+}
+
+void DeliveryFrame::put(std::string &out, Type type, uint64_t value, std::string_view payload)
+{
+    uint32_t size = static_cast<uint32_t>(header_size + payload.size());
+    out.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.append(reinterpret_cast<const char *>(&type), sizeof(type));
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    out.append(payload);
+}
+
+std::optional<DeliveryFrame::Frame> DeliveryFrame::parse(std::string_view data, size_t &used)
+{
+    used = 0;
+    uint32_t size;
+    if (data.size() < sizeof(size))
+        return std::nullopt;
+    std::memcpy(&size, data.data(), sizeof(size));
+
+    if (size < header_size || size > max_frame)
+    {
+        used = data.size(); // lost framing, drop what is buffered
+        return std::nullopt;
+    }
+    if (data.size() - sizeof(size) < size)
+        return std::nullopt; // incomplete
+
+    used = sizeof(size) + size;
+    Frame frame;
+    std::memcpy(&frame.type, data.data() + sizeof(size), sizeof(frame.type));
+    std::memcpy(&frame.value, data.data() + sizeof(size) + sizeof(frame.type), sizeof(frame.value));
+    frame.payload = data.substr(sizeof(size) + header_size, size - header_size);
+
+    if (frame.type != Type::Hello && frame.type != Type::Data)
+        return std::nullopt;
+    return frame;
+}
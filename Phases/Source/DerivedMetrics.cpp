@@ -0,0 +1,73 @@
+#include "DerivedMetrics.hpp"
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+DerivedMetrics::DerivedMetrics(const nlohmann::json &specs)
+{
+    if (!specs.is_array())
+        throw std::runtime_error("derived: expected an array");
+
+    size_t register_count = 0;
+    for (const auto &spec : specs)
+    {
+        if (!spec.contains("name") || !spec.contains("expr") || !spec.contains("policy"))
+            throw std::runtime_error("derived: every entry needs name, expr and policy");
+
+        std::string name = spec["name"];
+        try
+        {
+            derived.push_back({name, spec["policy"], Expression::compile(spec["expr"].get<std::string>(), table)});
+        }
+        catch (const std::runtime_error &e)
+        {
+            throw std::runtime_error("derived " + name + ": " + e.what());
+        }
+        register_count = std::max(register_count, derived.back().expr.registers());
+    }
+
+    values.resize(table.variableCount());
+    prefix_stats.resize(table.prefixCount());
+    regs.resize(register_count);
+}
+
+const DerivedMetrics::Binding &DerivedMetrics::binding(size_t position, std::string_view name)
+{
+    if (position < layout.size() && layout[position].name == name)
+        return layout[position];
+
+    // layout changed from here on
+    if (position < layout.size())
+    {
+        binding_prefixes.resize(layout[position].first_prefix);
+        layout.resize(position);
+    }
+    Binding b{std::string(name), table.find(name), binding_prefixes.size(), 0};
+    table.forPrefixesOf(name, [&](uint16_t prefix) { binding_prefixes.push_back(prefix); });
+    b.prefix_end = binding_prefixes.size();
+    layout.push_back(std::move(b));
+    return layout.back();
+}
+
+void DerivedMetrics::bind(const std::vector<MetricField> &fields)
+{
+    std::fill(values.begin(), values.end(), std::numeric_limits<double>::quiet_NaN());
+    std::fill(prefix_stats.begin(), prefix_stats.end(), PrefixStats{});
+
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        const Binding &b = binding(i, fields[i].policy);
+        if (b.slot < 0 && b.first_prefix == b.prefix_end)
+            continue; // not an input of any expression
+
+        double value;
+        auto [end, ec] = std::from_chars(fields[i].value.data(), fields[i].value.data() + fields[i].value.size(), value);
+        if (ec != std::errc())
+            continue;
+
+        if (b.slot >= 0)
+            values[b.slot] = value;
+        for (size_t p = b.first_prefix; p < b.prefix_end; ++p)
+            prefix_stats[binding_prefixes[p]].add(value);
+    }
+}
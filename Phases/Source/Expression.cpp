@@ -0,0 +1,332 @@
+#include "Expression.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+uint16_t VariableTable::variable(std::string_view name)
+{
+    auto it = variables.find(name);
+    if (it == variables.end())
+        it = variables.emplace(std::string(name), static_cast<uint16_t>(variables.size())).first;
+    return it->second;
+}
+
+uint16_t VariableTable::prefix(std::string_view name)
+{
+    auto it = prefixes.find(name);
+    if (it == prefixes.end())
+        it = prefixes.emplace(std::string(name), static_cast<uint16_t>(prefixes.size())).first;
+    return it->second;
+}
+
+int VariableTable::find(std::string_view name) const
+{
+    auto it = variables.find(name);
+    return it == variables.end() ? -1 : it->second;
+}
+
+void PrefixStats::add(double value)
+{
+    sum += value;
+    min = count == 0 ? value : std::min(min, value);
+    max = count == 0 ? value : std::max(max, value);
+    ++count;
+}
+
+// recursive descent that emits code as it parses: a sub-expression compiled for
+// register r leaves its value there and may use the registers above r as scratch
+class ExpressionCompiler
+{
+private:
+    std::string_view text;
+    size_t pos = 0;
+    VariableTable &table;
+    Expression &expr;
+
+    [[noreturn]] void fail(const std::string &what) const
+    {
+        throw std::runtime_error("expression \"" + std::string(text) + "\": " + what + " at " + std::to_string(pos));
+    }
+
+    void skipSpace()
+    {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+            ++pos;
+    }
+
+    bool accept(char c)
+    {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c)
+        {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!accept(c))
+            fail(std::string("expected '") + c + "'");
+    }
+
+    static bool identStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+    static bool identChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.'; }
+
+    std::string_view identifier()
+    {
+        size_t start = pos;
+        while (pos < text.size() && identChar(text[pos]))
+            ++pos;
+        return text.substr(start, pos - start);
+    }
+
+    void emit(Expression::Op op, uint16_t dst, uint16_t a = 0, uint16_t b = 0, double constant = 0)
+    {
+        if (dst >= expr.register_count)
+            expr.register_count = dst + 1;
+        expr.code.push_back({op, dst, a, b, constant});
+    }
+
+    static uint16_t next(uint16_t reg)
+    {
+        if (reg == UINT16_MAX - 1)
+            throw std::runtime_error("expression nested too deeply");
+        return reg + 1;
+    }
+
+    void sum(uint16_t reg)
+    {
+        term(reg);
+        for (;;)
+        {
+            if (accept('+'))
+            {
+                term(next(reg));
+                emit(Expression::Op::Add, reg, reg, reg + 1);
+            }
+            else if (accept('-'))
+            {
+                term(next(reg));
+                emit(Expression::Op::Sub, reg, reg, reg + 1);
+            }
+            else
+                return;
+        }
+    }
+
+    void term(uint16_t reg)
+    {
+        unary(reg);
+        for (;;)
+        {
+            if (accept('*'))
+            {
+                unary(next(reg));
+                emit(Expression::Op::Mul, reg, reg, reg + 1);
+            }
+            else if (accept('/'))
+            {
+                unary(next(reg));
+                emit(Expression::Op::Div, reg, reg, reg + 1);
+            }
+            else
+                return;
+        }
+    }
+
+    void unary(uint16_t reg)
+    {
+        if (accept('-'))
+        {
+            unary(reg);
+            emit(Expression::Op::Neg, reg, reg);
+        }
+        else if (accept('+'))
+            unary(reg);
+        else
+            primary(reg);
+    }
+
+    void primary(uint16_t reg)
+    {
+        skipSpace();
+        if (pos >= text.size())
+            fail("unexpected end");
+
+        if (accept('('))
+        {
+            sum(reg);
+            expect(')');
+            return;
+        }
+
+        char c = text[pos];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+        {
+            double value;
+            auto [end, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+            if (ec != std::errc())
+                fail("bad number");
+            pos = end - text.data();
+            emit(Expression::Op::Const, reg, 0, 0, value);
+            return;
+        }
+
+        if (!identStart(c))
+            fail(std::string("unexpected '") + c + "'");
+
+        std::string_view name = identifier();
+        if (!accept('('))
+        {
+            emit(Expression::Op::Var, reg, table.variable(name));
+            return;
+        }
+        call(name, reg);
+    }
+
+    // "cpu*)" right after an aggregate's '(' names a prefix, anything else is an argument
+    bool prefixArgument(std::string_view &prefix)
+    {
+        size_t start = pos;
+        skipSpace();
+        if (pos < text.size() && identStart(text[pos]))
+        {
+            prefix = identifier();
+            if (accept('*') && accept(')'))
+                return true;
+        }
+        pos = start;
+        return false;
+    }
+
+    void call(std::string_view name, uint16_t reg)
+    {
+        using Op = Expression::Op;
+
+        std::string_view prefix;
+        if ((name == "sum" || name == "avg" || name == "min" || name == "max" || name == "count") &&
+            prefixArgument(prefix))
+        {
+            Op op = name == "sum"   ? Op::PrefixSum
+                    : name == "avg" ? Op::PrefixAvg
+                    : name == "min" ? Op::PrefixMin
+                    : name == "max" ? Op::PrefixMax
+                                    : Op::PrefixCount;
+            emit(op, reg, table.prefix(prefix));
+            return;
+        }
+
+        if (name == "abs")
+        {
+            sum(reg);
+            expect(')');
+            emit(Op::Abs, reg, reg);
+            return;
+        }
+
+        if (name == "min" || name == "max")
+        {
+            Op op = name == "min" ? Op::Min : Op::Max;
+            sum(reg);
+            int args = 1;
+            while (accept(','))
+            {
+                sum(next(reg));
+                emit(op, reg, reg, reg + 1);
+                ++args;
+            }
+            expect(')');
+            if (args < 2)
+                fail(std::string(name) + "() needs two arguments or a prefix");
+            return;
+        }
+
+        fail("unknown function " + std::string(name));
+    }
+
+public:
+    ExpressionCompiler(std::string_view text, VariableTable &table, Expression &expr)
+        : text(text), table(table), expr(expr)
+    {
+    }
+
+    void compile()
+    {
+        sum(0);
+        skipSpace();
+        if (pos != text.size())
+            fail(std::string("unexpected '") + text[pos] + "'");
+    }
+};
+
+Expression Expression::compile(std::string_view text, VariableTable &table)
+{
+    Expression expr;
+    ExpressionCompiler(text, table, expr).compile();
+    return expr;
+}
+
+double Expression::evaluate(const double *variables, const PrefixStats *prefixes, double *regs) const
+{
+    for (const Instr &in : code)
+    {
+        double &dst = regs[in.dst];
+        switch (in.op)
+        {
+        case Op::Const:
+            dst = in.constant;
+            break;
+        case Op::Var:
+            dst = variables[in.a];
+            break;
+        case Op::Add:
+            dst = regs[in.a] + regs[in.b];
+            break;
+        case Op::Sub:
+            dst = regs[in.a] - regs[in.b];
+            break;
+        case Op::Mul:
+            dst = regs[in.a] * regs[in.b];
+            break;
+        case Op::Div:
+            // x/0 is no value rather than inf
+            dst = regs[in.b] == 0 ? std::numeric_limits<double>::quiet_NaN() : regs[in.a] / regs[in.b];
+            break;
+        case Op::Neg:
+            dst = -regs[in.a];
+            break;
+        case Op::Min:
+            dst = std::isnan(regs[in.a]) || std::isnan(regs[in.b]) ? std::numeric_limits<double>::quiet_NaN()
+                                                                   : std::min(regs[in.a], regs[in.b]);
+            break;
+        case Op::Max:
+            dst = std::isnan(regs[in.a]) || std::isnan(regs[in.b]) ? std::numeric_limits<double>::quiet_NaN()
+                                                                   : std::max(regs[in.a], regs[in.b]);
+            break;
+        case Op::Abs:
+            dst = std::fabs(regs[in.a]);
+            break;
+        case Op::PrefixSum:
+            dst = prefixes[in.a].count ? prefixes[in.a].sum : std::numeric_limits<double>::quiet_NaN();
+            break;
+        case Op::PrefixAvg:
+            dst = prefixes[in.a].count ? prefixes[in.a].sum / prefixes[in.a].count
+                                       : std::numeric_limits<double>::quiet_NaN();
+            break;
+        case Op::PrefixMin:
+            dst = prefixes[in.a].min;
+            break;
+        case Op::PrefixMax:
+            dst = prefixes[in.a].max;
+            break;
+        case Op::PrefixCount:
+            dst = prefixes[in.a].count;
+            break;
+        }
+    }
+    return code.empty() ? std::numeric_limits<double>::quiet_NaN() : regs[0];
+}
@@ -0,0 +1,248 @@
+#include "HeavyHitters.hpp"
+#include <algorithm>
+#include <functional>
+
+SpaceSaving::SpaceSaving(size_t capacity) : capacity(std::max<size_t>(capacity, 1))
+{
+    size_t slots = 1;
+    while (slots < 2 * this->capacity)
+        slots <<= 1;
+    index.resize(slots);
+    counters.reserve(this->capacity);
+    buckets.resize(this->capacity);
+    clear();
+}
+
+void SpaceSaving::clear()
+{
+    counters.clear();
+    for (uint32_t b = 0; b < buckets.size(); ++b)
+        buckets[b].next = b + 1 < buckets.size() ? b + 1 : none;
+    free_bucket = 0;
+    min_bucket = max_bucket = none;
+    std::fill(index.begin(), index.end(), none);
+    total = 0;
+}
+
+size_t SpaceSaving::slotOf(std::string_view key) const
+{
+    return std::hash<std::string_view>{}(key) & (index.size() - 1);
+}
+
+uint32_t SpaceSaving::find(std::string_view key) const
+{
+    for (size_t i = slotOf(key);; i = (i + 1) & (index.size() - 1))
+    {
+        if (index[i] == none)
+            return none;
+        if (counters[index[i]].key == key)
+            return index[i];
+    }
+}
+
+void SpaceSaving::indexInsert(uint32_t counter)
+{
+    size_t i = slotOf(counters[counter].key);
+    while (index[i] != none)
+        i = (i + 1) & (index.size() - 1);
+    index[i] = counter;
+}
+
+void SpaceSaving::indexErase(std::string_view key)
+{
+    const size_t mask = index.size() - 1;
+    size_t i = slotOf(key);
+    while (counters[index[i]].key != key)
+        i = (i + 1) & mask;
+    index[i] = none;
+
+    // backward shift: pull later entries of the probe run into the hole, unless their
+    // home slot lies after the hole
+    for (size_t j = (i + 1) & mask; index[j] != none; j = (j + 1) & mask)
+    {
+        size_t home = slotOf(counters[index[j]].key);
+        bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays)
+            continue;
+        index[i] = index[j];
+        index[j] = none;
+        i = j;
+    }
+}
+
+uint32_t SpaceSaving::newBucket(uint64_t count, uint32_t after)
+{
+    uint32_t b = free_bucket;
+    free_bucket = buckets[b].next;
+
+    buckets[b] = Bucket{count, none, after, after == none ? min_bucket : buckets[after].next};
+    if (buckets[b].prev != none)
+        buckets[buckets[b].prev].next = b;
+    else
+        min_bucket = b;
+    if (buckets[b].next != none)
+        buckets[buckets[b].next].prev = b;
+    else
+        max_bucket = b;
+    return b;
+}
+
+void SpaceSaving::unlink(uint32_t counter)
+{
+    Counter &c = counters[counter];
+    Bucket &b = buckets[c.bucket];
+    if (c.prev != none)
+        counters[c.prev].next = c.next;
+    else
+        b.first = c.next;
+    if (c.next != none)
+        counters[c.next].prev = c.prev;
+
+    if (b.first == none)
+    {
+        if (b.prev != none)
+            buckets[b.prev].next = b.next;
+        else
+            min_bucket = b.next;
+        if (b.next != none)
+            buckets[b.next].prev = b.prev;
+        else
+            max_bucket = b.prev;
+        b.next = free_bucket;
+        free_bucket = c.bucket;
+    }
+    c.bucket = c.prev = c.next = none;
+}
+
+void SpaceSaving::attach(uint32_t counter, uint32_t bucket)
+{
+    Counter &c = counters[counter];
+    c.bucket = bucket;
+    c.prev = none;
+    c.next = buckets[bucket].first;
+    if (c.next != none)
+        counters[c.next].prev = counter;
+    buckets[bucket].first = counter;
+}
+
+void SpaceSaving::increment(uint32_t counter)
+{
+    uint32_t b = counters[counter].bucket;
+    uint64_t want = buckets[b].count + 1;
+    uint32_t next = buckets[b].next;
+
+    if (next != none && buckets[next].count == want)
+    {
+        unlink(counter);
+        attach(counter, next);
+    }
+    else if (buckets[b].first == counter && counters[counter].next == none)
+        buckets[b].count = want; // alone: the bucket moves up with it
+    else
+    {
+        uint32_t created = newBucket(want, b);
+        unlink(counter);
+        attach(counter, created);
+    }
+}
+
+void SpaceSaving::add(std::string_view key)
+{
+    ++total;
+
+    uint32_t c = find(key);
+    if (c != none)
+    {
+        increment(c);
+        return;
+    }
+
+    if (counters.size() < capacity)
+    {
+        c = static_cast<uint32_t>(counters.size());
+        counters.push_back(Counter{std::string(key)});
+        indexInsert(c);
+        bool ones = min_bucket != none && buckets[min_bucket].count == 1;
+        attach(c, ones ? min_bucket : newBucket(1, none));
+        return;
+    }
+
+    // take over the smallest counter
+    c = buckets[min_bucket].first;
+    indexErase(counters[c].key);
+    counters[c].key.assign(key);
+    counters[c].error = buckets[min_bucket].count;
+    indexInsert(c);
+    increment(c);
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::top(size_t n) const
+{
+    std::vector<Entry> result;
+    for (uint32_t b = max_bucket; b != none && result.size() < n; b = buckets[b].prev)
+        for (uint32_t c = buckets[b].first; c != none && result.size() < n; c = counters[c].next)
+            result.push_back({counters[c].key, buckets[b].count, counters[c].error});
+    return result;
+}
+
+HotSources::HotSources(size_t capacity, size_t top_n) : messages(capacity), critical(capacity), top_n(top_n)
+{
+}
+
+void HotSources::record(const std::string &source, const LogMessage &message)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    messages.add(source);
+    if (message.level == severity_level::Critical)
+        critical.add(source);
+}
+
+std::vector<SpaceSaving::Entry> HotSources::topMessages()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return messages.top(top_n);
+}
+
+std::vector<SpaceSaving::Entry> HotSources::topCritical()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return critical.top(top_n);
+}
+
+namespace
+{
+    // "total=<n> <app>=<count> .." with "(+-<error>)" where the count is an estimate
+    LogMessage describe(const char *context, const SpaceSaving &counter, size_t n, int64_t now_ms)
+    {
+        std::string text = "total=" + std::to_string(counter.totalCount());
+        for (const auto &entry : counter.top(n))
+        {
+            text += ' ';
+            text += entry.key;
+            text += '=';
+            text += std::to_string(entry.count);
+            if (entry.error)
+                text += "(+-" + std::to_string(entry.error) + ")";
+        }
+        LogMessage msg{"topk", context, text, severity_level::Info, formatTimeStamp(now_ms)};
+        msg.event_time_ms = now_ms;
+        return msg;
+    }
+}
+
+std::vector<LogMessage> HotSources::report()
+{
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<LogMessage> out;
+    if (messages.totalCount())
+        out.push_back(describe("messages", messages, top_n, now_ms));
+    if (critical.totalCount())
+        out.push_back(describe("critical", critical, top_n, now_ms));
+    messages.clear();
+    critical.clear();
+    return out;
+}
@@ -0,0 +1,69 @@
+#include "LineParser.hpp"
+#include <charconv>
+
+LineParser::LineParser(line_format format, std::string default_policy, char delimiter)
+    : format(format), delimiter(delimiter), default_policy(std::move(default_policy))
+{
+}
+
+line_format LineParser::formatFromString(const std::string &name)
+{
+    if (name == "kv")
+        return line_format::KeyValue;
+    if (name == "csv")
+        return line_format::Csv;
+    return line_format::Single;
+}
+
+void LineParser::addField(std::string_view policy, std::string_view value)
+{
+    if (policy != "ts")
+    {
+        result.push_back({policy, value});
+        return;
+    }
+
+    int64_t ts = 0;
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), ts);
+    if (ec == std::errc())
+        event_time = ts;
+}
+
+const std::vector<MetricField> &LineParser::parse(std::string_view line)
+{
+    result.clear();
+    event_time.reset();
+
+    switch (format)
+    {
+    case line_format::Single:
+        result.push_back({default_policy, FieldSplitter::trim(line)});
+        break;
+
+    case line_format::KeyValue:
+        FieldSplitter::split(line, delimiter, fields);
+        for (auto field : fields)
+        {
+            size_t eq = field.find('=');
+            if (eq == std::string_view::npos)
+                continue;
+            addField(FieldSplitter::trim(field.substr(0, eq)), FieldSplitter::trim(field.substr(eq + 1)));
+        }
+        break;
+
+    case line_format::Csv:
+        FieldSplitter::split(line, delimiter, fields);
+        if (header.empty())
+        {
+            // first line names the columns
+            for (auto field : fields)
+                header.emplace_back(field);
+            break;
+        }
+        for (size_t i = 0; i < fields.size() && i < header.size(); ++i)
+            addField(header[i], fields[i]);
+        break;
+    }
+
+    return result;
+}
@@ -0,0 +1,118 @@
+#include "LogIndex.hpp"
+#include "Types_of_enums_data/telemetry_source.hpp"
+#include <cstring>
+#include <algorithm>
+
+uint32_t LogIndex::severityBit(severity_level level)
+{
+    return 1u << magic_enum::enum_integer(level);
+}
+
+uint32_t LogIndex::contextBit(std::string_view context)
+{
+    auto src = magic_enum::enum_cast<enum_telem_src>(context);
+    return src ? 1u << magic_enum::enum_integer(src.value()) : 1u << 31;
+}
+
+std::string LogIndex::indexPath(const std::string &log_path)
+{
+    return log_path + ".idx";
+}
+
+std::vector<LogIndexBlock> LogIndex::read(const std::string &index_path)
+{
+    std::vector<LogIndexBlock> blocks;
+    std::ifstream in(index_path, std::ios::binary);
+
+    char header[sizeof(magic)];
+    if (!in.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0)
+        return blocks;
+
+    LogIndexBlock block;
+    while (in.read(reinterpret_cast<char *>(&block), sizeof(block)))
+        blocks.push_back(block);
+    return blocks;
+}
+
+size_t LogIndex::seek(const std::vector<LogIndexBlock> &blocks, int64_t time_ms)
+{
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), time_ms,
+                               [](const LogIndexBlock &block, int64_t t)
+                               { return block.max_time_upto_ms < t; });
+    return static_cast<size_t>(it - blocks.begin());
+}
+
+void LogIndex::accumulate(std::vector<LogIndexBlock> &blocks)
+{
+    int64_t upto = std::numeric_limits<int64_t>::min();
+    for (auto &block : blocks)
+    {
+        upto = std::max(upto, block.max_time_ms);
+        block.max_time_upto_ms = upto;
+    }
+}
+
+LogIndexWriter::LogIndexWriter(const std::string &log_path, size_t block_lines, bool append, uint64_t start_offset)
+    : block_lines(block_lines)
+{
+    std::string path = LogIndex::indexPath(log_path);
+    auto existing = append ? LogIndex::read(path) : std::vector<LogIndexBlock>{};
+    bool resume = !existing.empty();
+    if (resume)
+        max_upto = existing.back().max_time_upto_ms;
+
+    index.open(path, std::ios::binary | (resume ? std::ios::app : std::ios::trunc));
+    if (!resume)
+        index.write(LogIndex::magic, sizeof(LogIndex::magic));
+
+    // lines after the last indexed block (previous run stopped mid-block) go into the next block
+    resetBlock(resume ? std::min(start_offset, existing.back().offset + existing.back().length) : start_offset);
+}
+
+void LogIndexWriter::resetBlock(uint64_t offset)
+{
+    block = LogIndexBlock{offset, 0, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(), 0, 0, 0};
+    lines = 0;
+}
+
+void LogIndexWriter::writeBlock()
+{
+    max_upto = std::max(max_upto, block.max_time_ms);
+    block.max_time_upto_ms = max_upto;
+    index.write(reinterpret_cast<const char *>(&block), sizeof(block));
+}
+
+void LogIndexWriter::add(const LogMessage &message, uint64_t end)
+{
+    add(message.event_time_ms, LogIndex::severityBit(message.level), LogIndex::contextBit(message.context), end);
+}
+
+void LogIndexWriter::add(int64_t time_ms, uint32_t severity_bit, uint32_t context_bit, uint64_t end)
+{
+    block.length = end - block.offset;
+    block.min_time_ms = std::min(block.min_time_ms, time_ms);
+    block.max_time_ms = std::max(block.max_time_ms, time_ms);
+    block.severity_mask |= severity_bit;
+    block.context_mask |= context_bit;
+
+    if (++lines >= block_lines)
+    {
+        writeBlock();
+        resetBlock(end);
+    }
+}
+
+void LogIndexWriter::close()
+{
+    if (lines > 0 && index.is_open())
+    {
+        writeBlock();
+        resetBlock(block.offset + block.length);
+    }
+    index.flush();
+}
+
+LogIndexWriter::~LogIndexWriter()
+{
+    close();
+}
@@ -0,0 +1,319 @@
+#include "LogMaintenance.hpp"
+#include "LogIndex.hpp"
+#include "LogMessage.hpp"
+#include "safe/SafeMappedFile.hpp"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <sys/syscall.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr size_t io_chunk = 64 * 1024;
+    constexpr int64_t closed_grace_ms = 60 * 1000; // no writes for this long before touching a segment
+
+    // linux/ioprio.h values, the header is not always installed
+    constexpr int ioprio_class_idle = 3;
+    constexpr int ioprio_class_shift = 13;
+    constexpr int ioprio_who_process = 1;
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    int64_t mtimeMs(const std::string &path)
+    {
+        struct stat st{};
+        if (::stat(path.c_str(), &st) != 0)
+            return 0;
+        return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+    }
+
+    struct MinuteStats
+    {
+        size_t count = 0;
+        float min = 0;
+        float max = 0;
+        double sum = 0;
+        size_t warning = 0;
+        size_t critical = 0;
+    };
+}
+
+LogMaintenance::LogMaintenance(MaintenanceConfig config)
+    : cfg(std::move(config)), bucket(cfg.io_bytes_per_s)
+{
+}
+
+LogMaintenance::~LogMaintenance()
+{
+    stop();
+}
+
+void LogMaintenance::start()
+{
+    worker = std::thread([this]()
+                         { run(); });
+}
+
+void LogMaintenance::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop_flag = true;
+    }
+    cv.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void LogMaintenance::run()
+{
+    // who = 0 is the calling thread, so only maintenance I/O is demoted
+    if (cfg.idle_io_priority &&
+        syscall(SYS_ioprio_set, ioprio_who_process, 0, ioprio_class_idle << ioprio_class_shift) == -1)
+        perror("ioprio_set");
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stop_flag)
+    {
+        lock.unlock();
+        try
+        {
+            pass();
+        }
+        catch (const std::exception &error)
+        {
+            std::cout << "[LogMaintenance] " << error.what() << "\n";
+        }
+        lock.lock();
+
+        cv.wait_for(lock, std::chrono::seconds(cfg.interval_s), [this]()
+                    { return stop_flag; });
+    }
+}
+
+bool LogMaintenance::isClosed(const LogSegment &segment, const LogSegment *next, int64_t now_ms) const
+{
+    // the newest segment is the one the sink appends to
+    return next != nullptr && now_ms - mtimeMs(segment.path) > closed_grace_ms;
+}
+
+uint64_t LogMaintenance::segmentBytes(const LogSegment &segment) const
+{
+    std::error_code ec;
+    uint64_t bytes = fs::file_size(segment.path, ec);
+    return ec ? 0 : bytes;
+}
+
+void LogMaintenance::removeSegment(const LogSegment &segment)
+{
+    std::error_code ec;
+    fs::remove(LogIndex::indexPath(segment.path), ec);
+    fs::remove(segment.path, ec);
+}
+
+void LogMaintenance::pass()
+{
+    int64_t now = nowMs();
+
+    auto closedSegments = [this, now]()
+    {
+        auto all = LogSegments::list(cfg.dir, cfg.prefix);
+        std::vector<LogSegment> closed;
+        for (size_t i = 0; i + 1 < all.size(); ++i)
+            if (isClosed(all[i], &all[i + 1], now))
+                closed.push_back(all[i]);
+        return closed;
+    };
+
+    // 1. old raw data -> per-minute summaries
+    if (cfg.downsample_after_ms > 0)
+    {
+        for (const auto &segment : closedSegments())
+            if (!segment.summary && segment.start_ms + cfg.period_ms < now - cfg.downsample_after_ms)
+                downsample(segment);
+    }
+
+    // 2. retention by age, summaries included
+    if (cfg.max_age_ms > 0)
+    {
+        for (const auto &segment : closedSegments())
+            if (segment.start_ms + cfg.period_ms < now - cfg.max_age_ms)
+                removeSegment(segment);
+    }
+
+    // 3. retention by size, oldest first; the open segment counts but is never removed
+    if (cfg.max_total_bytes > 0)
+    {
+        uint64_t total = 0;
+        for (const auto &segment : LogSegments::list(cfg.dir, cfg.prefix))
+            total += segmentBytes(segment);
+
+        for (const auto &segment : closedSegments())
+        {
+            if (total <= cfg.max_total_bytes)
+                break;
+            total -= std::min(total, segmentBytes(segment));
+            removeSegment(segment);
+        }
+    }
+
+    // 4. compaction: fold runs of small closed segments into the first one of the run
+    if (cfg.compact_below_bytes > 0)
+    {
+        auto closed = closedSegments();
+        const LogSegment *target = nullptr;
+        uint64_t target_bytes = 0;
+
+        for (const auto &segment : closed)
+        {
+            if (segment.summary)
+            {
+                target = nullptr; // raw runs only, and not across a summary
+                continue;
+            }
+            uint64_t bytes = segmentBytes(segment);
+            if (target && target_bytes + bytes <= cfg.compact_below_bytes)
+            {
+                append(*target, segment);
+                target_bytes += bytes;
+                continue;
+            }
+            target = (bytes < cfg.compact_below_bytes) ? &segment : nullptr;
+            target_bytes = bytes;
+        }
+    }
+}
+
+void LogMaintenance::downsample(const LogSegment &segment)
+{
+    std::map<std::pair<int64_t, std::string>, MinuteStats> minutes;
+
+    {
+        SafeMappedFile raw(segment.path);
+        std::string_view text = raw.view();
+
+        size_t pos = 0;
+        size_t charged = 0;
+        while (pos < text.size())
+        {
+            // pay for the pages before touching them
+            while (charged < std::min(text.size(), pos + io_chunk))
+            {
+                bucket.acquire(io_chunk);
+                charged += io_chunk;
+            }
+
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos)
+                end = text.size();
+            auto msg = parseLogLine(text.substr(pos, end - pos));
+            pos = end + 1;
+
+            auto value = msg ? parseLogValue(msg->message) : std::nullopt;
+            if (!value)
+                continue;
+
+            int64_t minute = msg->event_time_ms - msg->event_time_ms % 60000;
+            auto &stats = minutes[{minute, msg->context}];
+            stats.min = stats.count ? std::min(stats.min, *value) : *value;
+            stats.max = stats.count ? std::max(stats.max, *value) : *value;
+            stats.sum += *value;
+            ++stats.count;
+            stats.warning += msg->level == severity_level::Warning;
+            stats.critical += msg->level == severity_level::Critical;
+        }
+    }
+
+    std::string out_path = LogSegments::summaryPath(segment.path);
+    std::string tmp_path = out_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        std::ostringstream buffer;
+        for (const auto &[key, stats] : minutes)
+        {
+            severity_level worst = stats.critical ? severity_level::Critical
+                                   : stats.warning ? severity_level::Warning
+                                                   : severity_level::Info;
+            std::string text = "count=" + std::to_string(stats.count) +
+                               " min=" + std::to_string(stats.min) +
+                               " max=" + std::to_string(stats.max) +
+                               " avg=" + std::to_string(stats.sum / stats.count) +
+                               " warning=" + std::to_string(stats.warning) +
+                               " critical=" + std::to_string(stats.critical);
+
+            LogMessage summary{"summary", key.second, text, worst, formatTimeStamp(key.first)};
+            buffer << summary;
+
+            if (buffer.tellp() >= static_cast<std::streamoff>(io_chunk))
+            {
+                std::string chunk = buffer.str();
+                bucket.acquire(chunk.size());
+                out << chunk;
+                buffer.str("");
+            }
+        }
+        std::string chunk = buffer.str();
+        bucket.acquire(chunk.size());
+        out << chunk;
+        if (!out.flush())
+            throw std::runtime_error("Failed to write " + tmp_path);
+    }
+
+    // summary is complete on disk before the raw data goes away
+    fs::rename(tmp_path, out_path);
+    removeSegment(segment);
+}
+
+void LogMaintenance::append(const LogSegment &into, const LogSegment &from)
+{
+    uint64_t base = segmentBytes(into);
+
+    {
+        std::ifstream in(from.path, std::ios::binary);
+        std::ofstream out(into.path, std::ios::binary | std::ios::app);
+        std::vector<char> chunk(io_chunk);
+        while (in.read(chunk.data(), chunk.size()) || in.gcount() > 0)
+        {
+            bucket.acquire(static_cast<size_t>(in.gcount()) * 2); // read + write
+            out.write(chunk.data(), in.gcount());
+        }
+        if (!out.flush())
+            throw std::runtime_error("Failed to append to " + into.path);
+    }
+
+    // index of the merged file: own blocks, a catch-all block for any unindexed
+    // tail of `into`, then the blocks of `from` shifted by the old size
+    auto blocks = LogIndex::read(LogIndex::indexPath(into.path));
+    uint64_t indexed_end = blocks.empty() ? 0 : blocks.back().offset + blocks.back().length;
+    if (indexed_end < base)
+        blocks.push_back(LogIndexBlock{indexed_end, base - indexed_end, std::numeric_limits<int64_t>::min(),
+                                       std::numeric_limits<int64_t>::max(), ~0u, ~0u, 0});
+
+    for (auto block : LogIndex::read(LogIndex::indexPath(from.path)))
+    {
+        block.offset += base;
+        blocks.push_back(block);
+    }
+    LogIndex::accumulate(blocks);
+
+    std::string tmp_path = LogIndex::indexPath(into.path) + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(LogIndex::magic, sizeof(LogIndex::magic));
+        out.write(reinterpret_cast<const char *>(blocks.data()), blocks.size() * sizeof(LogIndexBlock));
+    }
+    fs::rename(tmp_path, LogIndex::indexPath(into.path));
+
+    removeSegment(from);
+}
@@ -1,4 +1,6 @@
 #include "LogManager.hpp"
+#include "LogProducer.hpp"
+#include <algorithm>
 
 void LogManager::add_sink(std::unique_ptr<ILogSink> sink)
 {
@@ -7,27 +9,187 @@ void LogManager::add_sink(std::unique_ptr<ILogSink> sink)
 
 void LogManager::log(const LogMessage &message)
 {
+    while (!messages.tryPush(message))
+        write(); // backpressure, as in log_batch
+    pool->push_task([this](){ this->write(); });
+}
+
+void LogManager::enable_reorder(int64_t lateness_ms, size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(write_mutex);
+    reorder.emplace(lateness_ms, capacity);
+}
 
-    if (!messages.tryPush(message))
+size_t LogManager::late_count()
+{
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return reorder ? reorder->lateCount() : 0;
+}
+
+void LogManager::add_correlation(CorrelationRule rule, size_t window_capacity)
+{
+    std::lock_guard<std::mutex> lock(write_mutex);
+    correlation.addRule(std::move(rule), window_capacity);
+}
+
+void LogManager::log_batch(const std::vector<LogMessage> &batch)
+{
+    if (batch.empty())
+        return;
+
+    size_t pushed = messages.tryPushBatch(batch);
+    while (pushed < batch.size())
     {
-        std::cout << "[LogManager] buffer full, message dropped\n";
+        write(); // backpressure: the caller makes room instead of losing the rest
+        pushed += messages.tryPushBatch(batch, pushed);
     }
     pool->push_task([this](){ this->write(); });
 }
 
+std::shared_ptr<ProducerLink> LogManager::attach(LogProducer &producer)
+{
+    std::lock_guard<std::mutex> lock(producers_mutex);
+    producers.push_back(&producer);
+    if (!sweeper.joinable() && !stopping)
+        sweeper = std::thread([this]() { sweep(); });
+    producers_cv.notify_all(); // its max_delay may shorten the sweep period
+    return link;
+}
+
+void LogManager::detach(LogProducer &producer)
+{
+    std::lock_guard<std::mutex> lock(producers_mutex);
+    auto it = std::find(producers.begin(), producers.end(), &producer);
+    if (it == producers.end())
+        return;
+    producers.erase(it);
+    producer.release();
+}
+
+void LogManager::sweep()
+{
+    std::unique_lock<std::mutex> lock(producers_mutex);
+    while (!stopping)
+    {
+        // half the shortest max_delay: nothing stays staged longer than 1.5 x its max_delay
+        auto period = std::chrono::milliseconds(500);
+        for (auto *producer : producers)
+            period = std::min(period, producer->maxDelay() / 2);
+        period = std::max(period, std::chrono::milliseconds(1));
+
+        if (producers_cv.wait_for(lock, period, [this]() { return stopping; }))
+            break;
+
+        auto now = std::chrono::steady_clock::now();
+        for (auto *producer : producers)
+            producer->flushOlder(now);
+    }
+}
+
+void LogManager::write_to_sinks(const LogMessage &message)
+{
+    for (auto &sink : sinks)
+    {
+        sink->write(message);
+    }
+
+    if (correlation.empty())
+        return;
+
+    composites.clear();
+    correlation.onMessage(message, composites);
+    for (const auto &composite : composites)
+    {
+        for (auto &sink : sinks)
+            sink->write(composite);
+    }
+}
+
+void LogManager::flush_sinks()
+{
+    for (auto &sink : sinks)
+    {
+        sink->flush();
+    }
+}
+
 void LogManager::write()
 {
+    std::lock_guard<std::mutex> lock(write_mutex);
+
     while (auto maybe_msg = messages.trypop())
     {
-        for (auto &sink : sinks)
-        {
-            sink->write(maybe_msg.value());
-        }
+        maybe_msg->render();
+        if (reorder)
+            reorder->push(std::move(maybe_msg.value()));
+        else
+            write_to_sinks(maybe_msg.value());
+    }
+
+    if (reorder)
+    {
+        int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+        while (auto ready = reorder->popReady(now_ms))
+            write_to_sinks(ready.value());
     }
+
+    flush_sinks();
+}
+
+void LogManager::write_now(const LogMessage &message)
+{
+    std::lock_guard<std::mutex> lock(write_mutex);
+    if (message.deferred)
+    {
+        LogMessage rendered = message;
+        rendered.render();
+        write_to_sinks(rendered);
+        return;
+    }
+    write_to_sinks(message);
+}
+
+void LogManager::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(producers_mutex);
+        for (auto *producer : producers)
+            producer->flush();
+    }
+    write();
+
+    std::lock_guard<std::mutex> lock(write_mutex);
+    if (reorder)
+    {
+        while (auto held = reorder->popAny())
+            write_to_sinks(held.value());
+    }
+    flush_sinks();
 }
 
 LogManager &LogManager::operator<<(const LogMessage &message)
 {
     this->log(message);
     return *this;
-}
\ No newline at end of file
+}
+LogManager::~LogManager()
+{
+    {
+        // a producer destroyed meanwhile waits on the link, then finds no manager
+        std::lock_guard<std::mutex> detaching(link->mtx);
+        link->manager = nullptr;
+        std::lock_guard<std::mutex> lock(producers_mutex);
+        stopping = true;
+        for (auto *producer : producers)
+            producer->release(); // a thread_local producer may outlive the manager
+        producers.clear();
+    }
+    producers_cv.notify_all();
+    if (sweeper.joinable())
+        sweeper.join();
+
+    flush();
+    pool.reset(); // queued write() tasks run while the members they use still exist
+}
@@ -1,10 +1,21 @@
 #include "LogMessage.hpp"
+#include <charconv>
+#include <functional>
 
 LogMessage::LogMessage(const std::string &app, const std::string &cntxt, const std::string &msg, severity_level sev, std::string time)
     : app_name(app), context(cntxt), message(msg), level(sev), time(time)
 {
 }
 
+void LogMessage::render()
+{
+    if (!deferred)
+        return;
+    message = deferred->render();
+    time = formatTimeStamp(event_time_ms);
+    deferred.reset();
+}
+
 std::ostream &operator<<(std::ostream &os, const LogMessage &msg)
 {
     os << "[" << msg.app_name << "] "
@@ -12,6 +23,99 @@ std::ostream &operator<<(std::ostream &os, const LogMessage &msg)
        << "[" << msg.context << "] "
        << "[" << magic_enum::enum_name(msg.level) << "] "
        << "[" << msg.message << "]"
-       << std::endl;
+       << '\n'; // sinks flush once per batch, not per line
     return os;
+}
+
+namespace
+{
+    int digits(std::string_view text, size_t pos, size_t count)
+    {
+        int value = 0;
+        for (size_t i = pos; i < pos + count; ++i)
+            value = value * 10 + (text[i] - '0');
+        return value;
+    }
+}
+
+std::optional<float> parseLogValue(std::string_view message)
+{
+    size_t colon = message.rfind(": ");
+    if (colon == std::string_view::npos)
+        return std::nullopt;
+
+    float value;
+    auto [end, ec] = std::from_chars(message.data() + colon + 2, message.data() + message.size(), value);
+    if (ec != std::errc())
+        return std::nullopt;
+    return value;
+}
+
+// mktime only runs once per hour of log
+int64_t parseTimeStamp(std::string_view time)
+{
+    if (time.size() < 19 || time[4] != '-' || time[10] != ' ' || time[13] != ':' || time[16] != ':')
+        return 0;
+
+    thread_local std::string cached_hour;
+    thread_local int64_t cached_hour_ms = 0;
+
+    std::string_view hour = time.substr(0, 13);
+    if (hour != cached_hour)
+    {
+        std::tm tm{};
+        tm.tm_year = digits(time, 0, 4) - 1900;
+        tm.tm_mon = digits(time, 5, 2) - 1;
+        tm.tm_mday = digits(time, 8, 2);
+        tm.tm_hour = digits(time, 11, 2);
+        tm.tm_isdst = -1;
+        cached_hour.assign(hour);
+        cached_hour_ms = static_cast<int64_t>(std::mktime(&tm)) * 1000;
+    }
+    return cached_hour_ms + (digits(time, 14, 2) * 60 + digits(time, 17, 2)) * 1000;
+}
+
+std::string formatTimeStamp(int64_t epoch_ms)
+{
+    std::time_t t = static_cast<std::time_t>(epoch_ms / 1000);
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+    return stamp;
+}
+
+uint64_t sourceKey(std::string_view source)
+{
+    return std::hash<std::string_view>{}(source) | 1;
+}
+
+std::optional<LogMessage> parseLogLine(std::string_view line)
+{
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    if (line.size() < 2 || line.front() != '[' || line.back() != ']')
+        return std::nullopt;
+
+    std::string_view fields[4];
+    size_t pos = 1;
+    for (auto &field : fields)
+    {
+        size_t end = line.find("] [", pos);
+        if (end == std::string_view::npos)
+            return std::nullopt;
+        field = line.substr(pos, end - pos);
+        pos = end + 3;
+    }
+    if (pos > line.size() - 1)
+        return std::nullopt;
+
+    auto level = magic_enum::enum_cast<severity_level>(fields[3]);
+    if (!level)
+        return std::nullopt;
+
+    LogMessage msg{std::string(fields[0]), std::string(fields[2]),
+                   std::string(line.substr(pos, line.size() - 1 - pos)), level.value(), std::string(fields[1])};
+    msg.event_time_ms = parseTimeStamp(fields[1]);
+    return msg;
 }
\ No newline at end of file
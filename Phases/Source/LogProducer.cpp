@@ -0,0 +1,69 @@
+#include "LogProducer.hpp"
+
+LogProducer::LogProducer(LogManager &manager, size_t batch_size, std::chrono::milliseconds max_delay)
+    : manager(&manager), batch_size(std::max<size_t>(batch_size, 1)), max_delay(max_delay)
+{
+    batch.reserve(this->batch_size);
+    link = manager.attach(*this);
+}
+
+void LogProducer::log(LogMessage message)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (batch.empty())
+        oldest = std::chrono::steady_clock::now();
+    batch.push_back(std::move(message));
+    if (batch.size() >= batch_size)
+        handOver();
+}
+
+void LogProducer::handOver()
+{
+    if (manager)
+        manager->log_batch(batch);
+    batch.clear();
+}
+
+void LogProducer::flush()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    handOver();
+}
+
+void LogProducer::flushOlder(std::chrono::steady_clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!batch.empty() && now - oldest >= max_delay)
+        handOver();
+}
+
+void LogProducer::release()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    handOver();
+    manager = nullptr;
+}
+
+LogProducer &LogProducer::local(LogManager &manager)
+{
+    thread_local std::unique_ptr<LogProducer> producer;
+
+    bool attached = false;
+    if (producer)
+    {
+        std::lock_guard<std::mutex> lock(producer->mtx);
+        attached = producer->manager == &manager;
+    }
+    if (!attached)
+        producer = std::make_unique<LogProducer>(manager); // old one flushes in its destructor
+    return *producer;
+}
+
+LogProducer::~LogProducer()
+{
+    // the manager cannot be destroyed while the link is held. detach hands over the rest;
+    // a manager already gone released this producer itself
+    std::lock_guard<std::mutex> lock(link->mtx);
+    if (link->manager)
+        link->manager->detach(*this);
+}
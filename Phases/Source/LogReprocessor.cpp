@@ -0,0 +1,114 @@
+#include "LogReprocessor.hpp"
+#include "safe/SafeMappedFile.hpp"
+#include "Formatter.hpp"
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+LogReprocessor::LogReprocessor(LogManager &logger, size_t thread_count, size_t chunk_bytes, bool reclassify)
+    : logger(logger), thread_count(std::max<size_t>(thread_count, 1)),
+      chunk_bytes(std::max<size_t>(chunk_bytes, 4096)), reclassify(reclassify)
+{
+}
+
+void LogReprocessor::reclassifyRecord(LogMessage &msg)
+{
+    auto parsed = parseLogValue(msg.message);
+    if (!parsed)
+        return;
+    float value = parsed.value();
+
+    switch (magic_enum::enum_cast<enum_telem_src>(msg.context).value_or(enum_telem_src::CPU))
+    {
+    case enum_telem_src::CPU:
+        Formatter<CPU_policy>::reclassify(msg, value);
+        break;
+    case enum_telem_src::GPU:
+        Formatter<GPU_policy>::reclassify(msg, value);
+        break;
+    case enum_telem_src::RAM:
+        Formatter<RAM_policy>::reclassify(msg, value);
+        break;
+    case enum_telem_src::IO:
+        Formatter<IO_policy>::reclassify(msg, value);
+        break;
+    }
+}
+
+void LogReprocessor::parseChunk(Chunk &chunk) const
+{
+    std::string_view text = chunk.text;
+    chunk.records.reserve(text.size() / 64); // typical line length
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+            end = text.size();
+
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (line.empty())
+            continue;
+
+        auto msg = parseLogLine(line);
+        if (!msg)
+        {
+            ++chunk.rejected;
+            continue;
+        }
+        if (reclassify && magic_enum::enum_cast<enum_telem_src>(msg->context))
+            reclassifyRecord(msg.value());
+        chunk.records.push_back(std::move(msg.value()));
+    }
+}
+
+LogReprocessor::Stats LogReprocessor::run(const std::vector<std::string> &paths)
+{
+    Stats stats;
+    auto started = std::chrono::steady_clock::now();
+
+    for (const auto &path : paths)
+    {
+        SafeMappedFile file(path);
+        std::string_view text = file.view();
+        stats.bytes += text.size();
+
+        size_t offset = 0;
+        while (offset < text.size())
+        {
+            // one round: up to thread_count line-aligned chunks parsed in parallel
+            std::vector<Chunk> chunks;
+            while (chunks.size() < thread_count && offset < text.size())
+            {
+                size_t end = std::min(offset + chunk_bytes, text.size());
+                size_t newline = text.find('\n', end);
+                end = (newline == std::string_view::npos) ? text.size() : newline + 1;
+
+                chunks.push_back(Chunk{text.substr(offset, end - offset), {}, 0});
+                offset = end;
+            }
+
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < chunks.size(); ++i)
+                workers.emplace_back([this, &chunks, i]()
+                                     { parseChunk(chunks[i]); });
+            parseChunk(chunks[0]);
+            for (auto &t : workers)
+                t.join();
+
+            // replay in file order
+            for (auto &chunk : chunks)
+            {
+                stats.records += chunk.records.size();
+                stats.rejected += chunk.rejected;
+                for (const auto &msg : chunk.records)
+                    logger.write_now(msg);
+            }
+        }
+    }
+
+    logger.flush();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return stats;
+}
@@ -0,0 +1,70 @@
+#include "LogSegments.hpp"
+#include "LogIndex.hpp"
+#include <filesystem>
+#include <algorithm>
+#include <ctime>
+
+namespace fs = std::filesystem;
+
+std::string LogSegments::segmentPath(const std::string &dir, const std::string &prefix, int64_t start_ms)
+{
+    std::time_t t = static_cast<std::time_t>(start_ms / 1000);
+    std::tm tm{};
+    localtime_r(&t, &tm);
+
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+    return dir + "/" + prefix + "-" + stamp + ".log";
+}
+
+std::string LogSegments::summaryPath(const std::string &segment_path)
+{
+    return segment_path.substr(0, segment_path.size() - 4) + ".summary.log";
+}
+
+std::vector<LogSegment> LogSegments::list(const std::string &dir, const std::string &prefix)
+{
+    std::vector<LogSegment> segments;
+    std::string head = prefix + "-";
+
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(dir, ec))
+    {
+        std::string name = entry.path().filename().string();
+        bool summary = name.size() == head.size() + 27 && name.compare(name.size() - 12, 12, ".summary.log") == 0;
+        if ((name.size() != head.size() + 19 && !summary) || name.compare(0, head.size(), head) != 0 ||
+            name.compare(name.size() - 4, 4, ".log") != 0)
+            continue;
+
+        std::tm tm{};
+        if (!strptime(name.c_str() + head.size(), "%Y%m%d-%H%M%S", &tm))
+            continue;
+        tm.tm_isdst = -1;
+
+        segments.push_back({static_cast<int64_t>(std::mktime(&tm)) * 1000, entry.path().string(), summary});
+    }
+
+    std::sort(segments.begin(), segments.end(),
+              [](const LogSegment &a, const LogSegment &b)
+              { return a.start_ms < b.start_ms; });
+    return segments;
+}
+
+size_t LogSegments::removeOlderThan(const std::string &dir, const std::string &prefix, int64_t period_ms,
+                                    int64_t cutoff_ms, const std::string &keep_path)
+{
+    size_t removed = 0;
+    for (const auto &segment : list(dir, prefix))
+    {
+        if (segment.start_ms + period_ms > cutoff_ms)
+            break; // oldest first, the rest are newer
+        if (segment.path == keep_path)
+            continue;
+
+        std::error_code ec;
+        fs::remove(LogIndex::indexPath(segment.path), ec);
+        if (fs::remove(segment.path, ec))
+            ++removed;
+    }
+    return removed;
+}
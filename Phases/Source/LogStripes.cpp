@@ -0,0 +1,171 @@
+#include "LogStripes.hpp"
+#include "LogMessage.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+std::string LogStripes::stripePath(const std::string &dir, const std::string &name, size_t stripe)
+{
+    return dir + "/" + name + ".stripe" + std::to_string(stripe) + ".log";
+}
+
+std::string LogStripes::manifestPath(const std::string &dir, const std::string &name)
+{
+    return dir + "/" + name + ".stripes";
+}
+
+std::string LogStripes::headerLines(const std::vector<std::string> &files)
+{
+    std::string out = "stripes " + std::to_string(files.size()) + "\n";
+    for (const auto &file : files)
+        out += "file " + file + "\n";
+    return out;
+}
+
+std::string LogStripes::batchLine(const StripeBatch &b)
+{
+    return "batch " + std::to_string(b.seq) + " " + std::to_string(b.stripe) + " " + std::to_string(b.offset) + " " +
+           std::to_string(b.length) + " " + std::to_string(b.min_time_ms) + " " + std::to_string(b.max_time_ms) + "\n";
+}
+
+std::optional<StripeManifest> StripeManifest::read(const std::string &path)
+{
+    std::ifstream in(path);
+    std::string line;
+    size_t count = 0;
+    if (!std::getline(in, line) || std::sscanf(line.c_str(), "stripes %zu", &count) != 1 || count == 0)
+        return std::nullopt;
+
+    StripeManifest manifest;
+    while (manifest.files.size() < count && std::getline(in, line))
+    {
+        if (line.rfind("file ", 0) != 0)
+            return std::nullopt;
+        manifest.files.push_back(line.substr(5));
+    }
+    if (manifest.files.size() != count)
+        return std::nullopt;
+
+    while (std::getline(in, line))
+    {
+        if (in.eof())
+            break; // no newline: torn by a crash mid-append
+        std::istringstream fields(line);
+        std::string tag;
+        StripeBatch b{};
+        if (fields >> tag >> b.seq >> b.stripe >> b.offset >> b.length >> b.min_time_ms >> b.max_time_ms &&
+            tag == "batch" && b.stripe < count)
+            manifest.batches.push_back(b);
+    }
+    return manifest;
+}
+
+namespace
+{
+    // "[app] [YYYY-MM-DD HH:MM:SS] ..." -> epoch ms, 0 when the line has no time
+    int64_t lineTime(std::string_view line)
+    {
+        size_t open = line.find("] [");
+        if (open == std::string_view::npos || open + 3 + 19 > line.size())
+            return 0;
+        return parseTimeStamp(line.substr(open + 3, 19));
+    }
+}
+
+StripeReader::StripeReader(const StripeManifest &manifest, int64_t from_ms, int64_t to_ms) : from(from_ms), to(to_ms)
+{
+    cursors.resize(manifest.files.size());
+    for (const auto &batch : manifest.batches)
+        cursors[batch.stripe].batches.push_back(batch);
+
+    for (size_t i = 0; i < cursors.size(); ++i)
+    {
+        auto &cursor = cursors[i];
+        if (cursor.batches.empty())
+            continue;
+        try
+        {
+            cursor.file = std::make_unique<SafeMappedFile>(manifest.files[i]);
+        }
+        catch (const std::runtime_error &)
+        {
+            skipped += cursor.batches.size(); // stripe lost with its disk
+            continue;
+        }
+        if (advance(cursor))
+            heap.push_back(i);
+    }
+    std::make_heap(heap.begin(), heap.end(), [this](size_t a, size_t b)
+                   { return later(a, b); });
+}
+
+bool StripeReader::later(size_t a, size_t b) const
+{
+    const Cursor &x = cursors[a];
+    const Cursor &y = cursors[b];
+    return x.time_ms != y.time_ms ? x.time_ms > y.time_ms : x.seq > y.seq;
+}
+
+bool StripeReader::advance(Cursor &cursor)
+{
+    for (;;)
+    {
+        while (cursor.rest.empty())
+        {
+            if (cursor.batch == cursor.batches.size())
+                return false;
+            const StripeBatch &b = cursor.batches[cursor.batch++];
+            if (b.max_time_ms < from || b.min_time_ms > to)
+            {
+                ++skipped;
+                continue;
+            }
+            if (b.offset + b.length > cursor.file->size())
+            {
+                skipped += cursor.batches.size() - cursor.batch + 1; // manifest ahead of the data on disk
+                cursor.batch = cursor.batches.size();
+                return false;
+            }
+            cursor.rest = cursor.file->view().substr(b.offset, b.length);
+            cursor.seq = b.seq;
+        }
+
+        size_t end = cursor.rest.find('\n');
+        if (end == std::string_view::npos)
+            end = cursor.rest.size();
+        cursor.line = cursor.rest.substr(0, end);
+        cursor.rest.remove_prefix(std::min(end + 1, cursor.rest.size()));
+
+        if (cursor.line.empty() || cursor.line[0] == '\0')
+            continue; // hole left by a failed batch write
+        cursor.time_ms = lineTime(cursor.line);
+        if (cursor.time_ms >= from && cursor.time_ms <= to)
+            return true;
+    }
+}
+
+bool StripeReader::next(std::string_view &line)
+{
+    auto cmp = [this](size_t a, size_t b)
+    { return later(a, b); };
+
+    // the cursor handed out last time moves on first, its line stayed valid until now
+    if (pending != npos)
+    {
+        if (advance(cursors[pending]))
+        {
+            heap.push_back(pending);
+            std::push_heap(heap.begin(), heap.end(), cmp);
+        }
+        pending = npos;
+    }
+    if (heap.empty())
+        return false;
+
+    std::pop_heap(heap.begin(), heap.end(), cmp);
+    pending = heap.back();
+    heap.pop_back();
+    line = cursors[pending].line;
+    return true;
+}
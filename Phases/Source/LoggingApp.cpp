@@ -1,21 +1,47 @@
 #include "LoggingApp.hpp"
 #include "sinks/ConsoleSinkImpl.hpp"
 #include "sinks/FileSinkImpl.hpp"
+#include "sinks/FailoverFileSinkImpl.hpp"
+#include "sinks/StripedFileSinkImpl.hpp"
+#include "sinks/SegmentedFileSinkImpl.hpp"
+#include "sinks/ArchiveSinkImpl.hpp"
+#include "sinks/StagingSinkImpl.hpp"
+#include "sinks/SummarySinkImpl.hpp"
+#include "sinks/TailSinkImpl.hpp"
 #include "LogMessage.hpp"
+#include "LogReprocessor.hpp"
 #include <iostream>
 #include <chrono>
 #include <optional>
 #include <csignal>
+#include <charconv>
 
 // Global pointer to handle signals
 static TelemetryLoggingApp *g_app_instance = nullptr;
 
+namespace
+{
+    int64_t wallClockMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // "name" of a source entry, its endpoint when not set
+    std::string sourceId(const nlohmann::json &source, std::string endpoint)
+    {
+        return source.value("name", std::move(endpoint));
+    }
+}
+
 TelemetryLoggingApp::TelemetryLoggingApp(const std::string &configPath)
 {
     loadConfig(configPath);
-    setupSinks();
+    setupSinks(sinks, config["sinks"]);
+    setupNodeSinks(sinks);
 
-    logger = std::make_unique<LogManager>(buffer_capacity, thread_pool_size);
+    logger = std::make_unique<LogManager>(thread_pool_size, buffer_capacity);
 
     // add sinks to logger
     for (auto &sink : sinks)
@@ -23,6 +49,59 @@ TelemetryLoggingApp::TelemetryLoggingApp(const std::string &configPath)
         logger->add_sink(std::move(sink));
     }
 
+    // event-time reordering before sinks
+    if (config["log_manager"].contains("reorder") && config["log_manager"]["reorder"].value("enabled", false))
+    {
+        logger->enable_reorder(config["log_manager"]["reorder"].value("lateness_ms", 2000),
+                               config["log_manager"]["reorder"].value("capacity", 1024));
+    }
+
+    // per-thread staging queues in front of the shared ring
+    if (config["log_manager"].contains("staging") && config["log_manager"]["staging"].value("enabled", false))
+    {
+        auto &st = config["log_manager"]["staging"];
+        staging = std::make_unique<StagingBackend>(*logger, st.value("queue_capacity", 1024),
+                                                   std::chrono::milliseconds(st.value("poll_ms", 10)),
+                                                   st.value("ordered", false), st.value("merge_grace_ms", 0));
+    }
+
+    // cross-source correlation rules
+    if (config.contains("correlation"))
+    {
+        size_t window_capacity = config["correlation"].value("window_capacity", 64);
+        for (auto &r : config["correlation"].value("rules", nlohmann::json::array()))
+        {
+            CorrelationRule rule;
+            rule.name = r.value("name", "correlation");
+            rule.contexts = r.value("contexts", std::vector<std::string>{});
+            rule.level = magic_enum::enum_cast<severity_level>(r.value("level", "Critical")).value_or(severity_level::Critical);
+            rule.window_ms = r.value("window_ms", 2000);
+            rule.min_count = r.value("min_count", 1);
+
+            if (rule.contexts.size() >= 2)
+                logger->add_correlation(std::move(rule), window_capacity);
+        }
+    }
+
+    // top-k hottest sources on the ingest path, reported as "topk" records
+    if (config.contains("hot_sources") && config["hot_sources"].value("enabled", false))
+    {
+        auto &h = config["hot_sources"];
+        hotSources = std::make_unique<HotSources>(h.value("capacity", 64), h.value("top", 10));
+        hot_report_ms = h.value("report_s", 60) * 1000;
+    }
+
+    // per-source deadlines: Critical record when a source goes quiet, Info when it is back
+    if (config.contains("liveness") && config["liveness"].value("enabled", false))
+    {
+        auto &l = config["liveness"];
+        liveness = std::make_unique<StaleSources>(l.value("timeout_ms", 5000), l.value("tick_ms", 100), wallClockMs());
+    }
+
+    // configured DAG of stages instead of the fixed sources -> Formatter -> LogManager path
+    if (config.contains("pipeline") && config["pipeline"].value("enabled", false))
+        setupPipeline();
+
     g_app_instance = this;
 
     // handle Ctrl+C
@@ -32,12 +111,25 @@ TelemetryLoggingApp::TelemetryLoggingApp(const std::string &configPath)
 
 TelemetryLoggingApp::~TelemetryLoggingApp()
 {
+#if defined(ITI_WITH_SOMEIP) && defined(ITI_WITH_COROUTINES)
+    // the singleton outlives the app, its callback must not reach the event or executor
+    if (someipEvent)
+        SomeIPTelemetrySourceImpl::instance().setNotify(nullptr);
+#endif
     isRunning = false;
     for (auto &t : sourceThreads)
         if (t.joinable())
             t.join();
     if (writerThread_.joinable())
         writerThread_.join();
+    pipeline.reset();
+    summaries.reset();
+    if (tail)
+        tail->stop();
+    staging.reset();
+    shards.reset(); // before shardMerge, shards may still hand it messages
+    shardMerge.reset();
+    maintenance.reset();
 }
 
 void TelemetryLoggingApp::loadConfig(const std::string &path)
@@ -52,66 +144,202 @@ void TelemetryLoggingApp::loadConfig(const std::string &path)
     sink_flush_rate_ms = config["log_manager"].value("sink_flush_rate_ms", 500);
 }
 
-void TelemetryLoggingApp::setupSinks()
+namespace
+{
+    // "logs/output.log" + ".shard1" -> "logs/output.shard1.log"
+    std::string withSuffix(const std::string &path, const std::string &suffix)
+    {
+        size_t slash = path.rfind('/');
+        size_t dot = path.rfind('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            return path + suffix;
+        return path.substr(0, dot) + suffix + path.substr(dot);
+    }
+}
+
+void TelemetryLoggingApp::setupSinks(std::vector<std::unique_ptr<ILogSink>> &sinks, const nlohmann::json &cfg,
+                                     const std::string &suffix)
 {
     // console sink
-    if (config["sinks"]["console"].value("enabled", false))
+    if (cfg.contains("console") && cfg["console"].value("enabled", false))
     {
         sinks.push_back(std::make_unique<ConsoleSinkImpl>());
     }
 
     // file sinks
-    if (config["sinks"].contains("files"))
+    if (cfg.contains("files"))
     {
-        for (auto &f : config["sinks"]["files"])
+        for (auto &f : cfg["files"])
         {
             if (f.value("enabled", false))
             {
                 std::string path = f.value("path", "");
-                if (!path.empty())
-                    sinks.push_back(std::make_unique<FileSinkImpl>(path));
+                size_t index_block_lines = f.value("index", false) ? f.value("index_block_lines", 1024) : 0;
+                if (path.empty())
+                    continue;
+
+                // "backup": the same log written to a second file only while this one is unhealthy
+                if (f.contains("backup") && f["backup"].value("enabled", true))
+                {
+                    auto &b = f["backup"];
+                    FailoverConfig fo;
+                    fo.primary_path = withSuffix(path, suffix);
+                    fo.backup_path = withSuffix(b.value("path", path + ".backup"), suffix);
+                    fo.index_block_lines = index_block_lines;
+                    fo.latency = std::chrono::milliseconds(b.value("latency_ms", 200));
+                    fo.slow_flushes = b.value("slow_flushes", 3);
+                    fo.probe_interval = std::chrono::milliseconds(b.value("probe_ms", 1000));
+                    fo.resync = b.value("resync", true);
+                    sinks.push_back(std::make_unique<FailoverFileSinkImpl>(std::move(fo)));
+                }
+                else
+                    sinks.push_back(std::make_unique<FileSinkImpl>(withSuffix(path, suffix), index_block_lines));
             }
         }
     }
+
+    // time-partitioned segments with per-segment index
+    if (cfg.contains("segments") && cfg["segments"].value("enabled", false))
+    {
+        auto &seg = cfg["segments"];
+        sinks.push_back(std::make_unique<SegmentedFileSinkImpl>(
+            seg.value("dir", "logs/segments"),
+            seg.value("prefix", "output") + suffix,
+            static_cast<int64_t>(seg.value("segment_minutes", 60)) * 60 * 1000,
+            seg.value("index_block_lines", 1024),
+            static_cast<int64_t>(seg.value("retention_hours", 0)) * 3600 * 1000));
+    }
+
+    // one log striped over several disks, read back in time order through its manifest
+    if (cfg.contains("stripes") && cfg["stripes"].value("enabled", false))
+    {
+        auto &st = cfg["stripes"];
+        StripeConfig sc;
+        sc.dirs = st.value("dirs", std::vector<std::string>{});
+        sc.name = st.value("name", "output") + suffix;
+        sc.by_source = st.value("mode", "round_robin") == "source";
+        sc.batch_bytes = st.value("batch_kb", 256ull) << 10;
+        sc.queue_batches = st.value("queue_batches", 16);
+        sinks.push_back(std::make_unique<StripedFileSinkImpl>(std::move(sc)));
+    }
+
+    // multi-resolution round-robin archive per source
+    if (cfg.contains("archive") && cfg["archive"].value("enabled", false))
+    {
+        auto &arc = cfg["archive"];
+        std::vector<MetricArchive::Resolution> layout;
+        for (auto &r : arc.value("resolutions", nlohmann::json::array()))
+        {
+            int64_t step_s = r.value("step_s", 60);
+            int64_t rows = r.value("rows", 1440);
+            if (step_s <= 0 || rows <= 0 || rows > UINT32_MAX)
+                throw std::runtime_error("archive resolution needs step_s > 0 and rows > 0: " + r.dump());
+            layout.push_back({step_s * 1000, static_cast<uint32_t>(rows), 0});
+        }
+        if (layout.empty())
+            layout = MetricArchive::defaultLayout();
+
+        sinks.push_back(std::make_unique<ArchiveSinkImpl>(arc.value("dir", "logs/archive"), layout));
+    }
+}
+
+void TelemetryLoggingApp::setupNodeSinks(std::vector<std::unique_ptr<ILogSink>> &sinks, const std::string &suffix)
+{
+    // edge node: per-window summaries shipped to the central instance through a WAL
+    if (config.contains("edge") && config["edge"].value("enabled", false))
+    {
+        auto &edge = config["edge"];
+        sinks.push_back(std::make_unique<SummarySinkImpl>(edge.value("central_ip", "127.0.0.1"),
+                                                          edge.value("central_port", 24000),
+                                                          static_cast<int64_t>(edge.value("window_s", 10)) * 1000,
+                                                          withSuffix(edge.value("wal_dir", "logs/wal"), suffix),
+                                                          edge.value("wal_segment_mb", 16ull) << 20,
+                                                          edge.value("wal_max_mb", 1024ull) << 20));
+    }
+
+    // live tail: one server, a sink per sink set (shards) feeding it
+    if (config.contains("tail") && config["tail"].value("enabled", false))
+    {
+        if (!tail)
+        {
+            auto &t = config["tail"];
+            tail = std::make_shared<TailServer>(t.value("port", 24100), t.value("unix_path", ""),
+                                                t.value("max_buffer_kb", 1024ull) << 10, t.value("batch_ms", 100));
+        }
+        sinks.push_back(std::make_unique<TailSinkImpl>(tail));
+    }
+}
+
+void TelemetryLoggingApp::runPeriodic(int rate_ms, std::function<bool()> setup, std::function<void()> tick)
+{
+#ifdef ITI_WITH_COROUTINES
+    if (executor)
+    {
+        executor->spawn(coro::periodic(*executor, std::chrono::milliseconds(rate_ms), std::move(setup), std::move(tick), isRunning));
+        return;
+    }
+#endif
+    sourceThreads.emplace_back([this, rate_ms, setup, tick]()
+                               {
+        if (setup && !setup())
+            return;
+
+        while (isRunning) {
+            tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(rate_ms));
+        } });
 }
 
 void TelemetryLoggingApp::setupTelemetrySources()
 {
+    // "threads": one blocking loop per source, "coroutines": all sources on one epoll executor
+    std::string model = config["sources"].value("execution", "threads");
+#ifdef ITI_WITH_COROUTINES
+    if (model == "coroutines")
+        executor = std::make_unique<coro::EpollExecutor>();
+#else
+    if (model == "coroutines")
+        std::cout << "[TelemetryLoggingApp] built without coroutines, sources run on threads\n";
+#endif
+
+    // the configured DAG names its own sources
+    if (pipeline)
+    {
+        setupPipelineSources();
+        startExecutor();
+        return;
+    }
+
+    // every configured source has a liveness deadline from the start, a source that
+    // never sends is reported like one that stopped
+    auto watch = [this](const std::string &id)
+    {
+        if (liveness)
+            liveness->watch(id, wallClockMs());
+    };
+
     // FILE source
     if (config["sources"]["file"].value("enabled", false))
     {
         std::string path = config["sources"]["file"].value("path", "");
         int rate = config["sources"]["file"].value("parse_rate_ms", 1000);
         std::string policy = config["sources"]["file"].value("policy", "cpu");
+        line_format format = LineParser::formatFromString(config["sources"]["file"].value("format", "single"));
+        std::string id = sourceId(config["sources"]["file"], "file:" + path);
+        watch(id);
 
-        sourceThreads.emplace_back([this, path, rate, policy]()
-            {
-            auto source = std::make_unique<FileTelemetrySrc>(path);
-
-            if (!source->openSource())
-                return;
-
-            while (isRunning)
-            {
-                std::string raw;
-
-                if (source->readSource(raw))
-                {
-                    std::optional<LogMessage> msg;
-
-                    if (policy == "cpu")
-                        msg = Formatter<CPU_policy>::format(raw);
-                    else if (policy == "ram")
-                        msg = Formatter<RAM_policy>::format(raw);
-                    else if (policy == "gpu")
-                        msg = Formatter<GPU_policy>::format(raw);
+        auto source = std::make_shared<FileTelemetrySrc>(path);
+        auto parser = std::make_shared<LineParser>(format, policy);
+        auto derived = makeDerived(format);
 
-                    if (msg.has_value())
-                        logger->log(msg.value());
-                }
+        runPeriodic(rate, [source]()
+                    { return source->openSource(); },
+                    [this, source, parser, derived, id]()
+                    {
+            std::string raw;
 
-                std::this_thread::sleep_for(std::chrono::milliseconds(rate));
-            } });
+            if (source->readSource(raw))
+                emitLine(*parser, derived.get(), id, raw); });
     }
 
     // to run soket use this command nc -lk 12345 and add number needed to show in soket
@@ -122,49 +350,273 @@ void TelemetryLoggingApp::setupTelemetrySources()
         uint16_t port = config["sources"]["socket"].value("port", 12345);
         int rate = config["sources"]["socket"].value("parse_rate_ms", 1000);
         std::string policy = config["sources"]["socket"].value("policy", "ram");
+        line_format format = LineParser::formatFromString(config["sources"]["socket"].value("format", "single"));
+        std::string id = sourceId(config["sources"]["socket"], "socket:" + ip + ":" + std::to_string(port));
+        watch(id);
 
-        sourceThreads.emplace_back([this, ip, port, rate, policy]()
-                                   {
-        auto source = std::make_unique<SocketTelemetrySrc>(ip, port); // دلوقتي صح
-        while (isRunning) {
-        if (source->openSource()) {
-            std::string raw;
-            if (source->readSource(raw)) {
-                std::optional<LogMessage> msg;
-                if (policy == "cpu") msg = Formatter<CPU_policy>::format(raw);
-                else if (policy == "ram") msg = Formatter<RAM_policy>::format(raw);
-                else if (policy == "gpu") msg = Formatter<GPU_policy>::format(raw);
+        auto parser = std::make_shared<LineParser>(format, policy);
+        auto derived = makeDerived(format);
+        auto onLine = [this, parser, derived, id](std::string &raw)
+        { emitLine(*parser, derived.get(), id, raw); };
 
-                if (msg.has_value()) logger->log(msg.value());
-            }
+#ifdef ITI_WITH_COROUTINES
+        if (executor)
+            executor->spawn(coro::socketLines(*executor, ip, port, std::chrono::milliseconds(rate), onLine, isRunning));
+        else
+#endif
+        {
+            auto source = std::make_shared<SocketTelemetrySrc>(ip, port); // دلوقتي صح
+            runPeriodic(rate, nullptr, [source, onLine]()
+                        {
+            if (source->openSource()) {
+                std::string raw;
+                if (source->readSource(raw))
+                    onLine(raw);
+            } });
         }
-            std::this_thread::sleep_for(std::chrono::milliseconds(rate));
-        } });
     }
 
     // SOMEIP source
+#ifdef ITI_WITH_SOMEIP
     if (config["sources"]["someip"].value("enabled", false))
     {
         int rate = config["sources"]["someip"].value("parse_rate_ms", 1000);
         std::string policy = config["sources"]["someip"].value("policy", "gpu");
+        std::string id = sourceId(config["sources"]["someip"], "someip");
+        watch(id);
+
+        auto onValue = [this, policy, id](std::string &raw)
+        {
+            auto msg = formatWithPolicy(policy, raw);
+            if (msg.has_value()) emit(std::move(msg.value()), id);
+        };
+
+#ifdef ITI_WITH_COROUTINES
+        if (executor)
+        {
+            // event subscription instead of a request per tick
+            auto &source = SomeIPTelemetrySourceImpl::instance();
+            if (source.openSource())
+            {
+                someipEvent = std::make_unique<coro::Event>(*executor);
+                source.setNotify([event = someipEvent.get()]()
+                                 { event->set(); });
+                source.start();
+                executor->spawn(coro::onEvent(*someipEvent, [&source](std::string &out)
+                                              { return source.readEvent(out); },
+                                              onValue, isRunning));
+            }
+        }
+        else
+#endif
+        runPeriodic(rate, []()
+                    { return SomeIPTelemetrySourceImpl::instance().openSource(); },
+                    [onValue]()
+                    {
+            std::string raw;
+            if (SomeIPTelemetrySourceImpl::instance().readSource(raw))
+                onValue(raw); });
+    }
+#else
+    if (config["sources"]["someip"].value("enabled", false))
+        std::cout << "[TelemetryLoggingApp] built without SOME/IP, someip source ignored\n";
+#endif
 
-        sourceThreads.emplace_back([this, rate, policy]()
-                                   {
-        auto &source = SomeIPTelemetrySourceImpl::instance();
-        if (!source.openSource()) return;
+    // CGROUP source: one loop samples every container under the cgroup v2 root
+    if (config["sources"].contains("cgroup") && config["sources"]["cgroup"].value("enabled", false))
+    {
+        std::string root = config["sources"]["cgroup"].value("root", "/sys/fs/cgroup");
+        int depth = config["sources"]["cgroup"].value("max_depth", 3);
+        int rate = config["sources"]["cgroup"].value("parse_rate_ms", 1000);
 
-        while (isRunning) {
+        auto source = std::make_shared<CgroupTelemetrySrc>(root, depth);
+
+        runPeriodic(rate, [source]()
+                    { return source->openSource(); },
+                    [this, source]()
+                    {
+            source->sample();
+
+            // line layout: "<cgroup> <metric> <value>", cgroup is the first field and may hold spaces, so split from the end
             std::string raw;
-            if (source.readSource(raw)) {
-                std::optional<LogMessage> msg;
-                if (policy == "cpu") msg = Formatter<CPU_policy>::format(raw);
-                else if (policy == "ram") msg = Formatter<RAM_policy>::format(raw);
-                else if (policy == "gpu") msg = Formatter<GPU_policy>::format(raw);
+            while (source->readSource(raw)) {
+                size_t value_pos = raw.rfind(' ');
+                size_t metric_pos = raw.rfind(' ', value_pos - 1);
+                if (value_pos == std::string::npos || metric_pos == std::string::npos) continue;
+
+                std::string_view line = raw;
+                std::string cgroup = raw.substr(0, metric_pos);
+                auto msg = formatWithPolicy(line.substr(metric_pos + 1, value_pos - metric_pos - 1), line.substr(value_pos + 1));
+                if (msg.has_value()) {
+                    msg->app_name = cgroup; // tag with the container instead of the metric name
+                    emit(std::move(msg.value()), cgroup);
+                }
+            } });
+    }
+
+    startExecutor();
+}
+
+void TelemetryLoggingApp::startExecutor()
+{
+#ifdef ITI_WITH_COROUTINES
+    if (executor)
+    {
+        sourceThreads.emplace_back([this]()
+                                   { executor->run(isRunning); });
+    }
+#endif
+}
+
+void TelemetryLoggingApp::setupPipeline()
+{
+    // sink stages take the keys of "sinks", plus "tail": true to feed the live-tail server
+    pipeline = std::make_unique<Pipeline>(config["pipeline"], [this](const nlohmann::json &stage)
+                                          {
+        std::vector<std::unique_ptr<ILogSink>> stageSinks;
+        setupSinks(stageSinks, stage);
+        if (stage.value("tail", false) && tail)
+            stageSinks.push_back(std::make_unique<TailSinkImpl>(tail));
+        return stageSinks; });
+}
+
+void TelemetryLoggingApp::setupPipelineSources()
+{
+    for (const auto &source : pipeline->sources())
+    {
+        const auto &cfg = source.config;
+        std::string type = cfg.value("type", "");
+        int rate = cfg.value("parse_rate_ms", 1000);
+        size_t node = source.node;
+        auto onLine = [this, node](std::string &raw)
+        {
+            pipeline->push(node, RawLine{std::move(raw)});
+        };
 
-                if (msg.has_value()) logger->log(msg.value());
+        if (type == "file")
+        {
+            auto src = std::make_shared<FileTelemetrySrc>(cfg.value("path", ""));
+            runPeriodic(rate, [src]()
+                        { return src->openSource(); },
+                        [src, onLine]()
+                        {
+                std::string raw;
+                if (src->readSource(raw))
+                    onLine(raw); });
+        }
+        else if (type == "socket")
+        {
+            std::string ip = cfg.value("ip", "127.0.0.1");
+            uint16_t port = cfg.value("port", 12345);
+#ifdef ITI_WITH_COROUTINES
+            if (executor)
+            {
+                executor->spawn(coro::socketLines(*executor, ip, port, std::chrono::milliseconds(rate), onLine, isRunning));
+                continue;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(rate));
-        } });
+#endif
+            auto src = std::make_shared<SocketTelemetrySrc>(ip, port);
+            runPeriodic(rate, nullptr, [src, onLine]()
+                        {
+                if (src->openSource()) {
+                    std::string raw;
+                    if (src->readSource(raw))
+                        onLine(raw);
+                } });
+        }
+        else
+            std::cout << "[TelemetryLoggingApp] pipeline source '" << source.name << "' has unknown type '" << type << "', skipped\n";
+    }
+}
+
+void TelemetryLoggingApp::emit(LogMessage message, const std::string &source)
+{
+    message.source_key = sourceKey(source); // shard and stripe choice
+    if (hotSources)
+        hotSources->record(source, message);
+    if (liveness)
+        if (auto recovered = liveness->seen(source, wallClockMs()))
+            route(std::move(*recovered));
+    route(std::move(message));
+}
+
+void TelemetryLoggingApp::route(LogMessage message)
+{
+    if (shards)
+        shards->log(message);
+    else if (staging)
+        staging->log(std::move(message));
+    else
+        logger->log(message);
+}
+
+void TelemetryLoggingApp::emitLine(LineParser &parser, DerivedMetrics *derived, const std::string &source, std::string_view raw)
+{
+    const auto &fields = parser.parse(raw);
+    for (const auto &field : fields)
+    {
+        auto msg = formatWithPolicy(field.policy, field.value, parser.eventTime());
+        if (msg.has_value())
+            emit(std::move(msg.value()), source);
+    }
+
+    if (derived)
+        derived->compute(fields, [&](const DerivedMetrics::Derived &d, double value)
+                         {
+            auto msg = formatWithPolicy(d.policy, static_cast<float>(value), parser.eventTime());
+            if (msg.has_value())
+            {
+                msg->app_name = d.name;
+                emit(std::move(msg.value()), source);
+            } });
+}
+
+std::shared_ptr<DerivedMetrics> TelemetryLoggingApp::makeDerived(line_format format) const
+{
+    if (!config.contains("derived") || !config["derived"].value("enabled", false))
+        return nullptr;
+    if (format == line_format::Single)
+    {
+        // the only field is the policy's own value, no expression could ever complete
+        std::cout << "[TelemetryLoggingApp] derived metrics need kv or csv lines, skipped for a single-value source\n";
+        return nullptr;
+    }
+    return std::make_shared<DerivedMetrics>(config["derived"].value("metrics", nlohmann::json::array()));
+}
+
+void TelemetryLoggingApp::setupShards()
+{
+    auto &sh = config["log_manager"]["shards"];
+    shards = std::make_unique<ShardedLogManager>(sh.value("count", 0), buffer_capacity, sh.value("pin", true));
+
+    nlohmann::json assign = sh.value("assign", nlohmann::json::object());
+    for (auto &[key, index] : assign.items())
+        shards->assign(key, index.get<size_t>());
+
+    if (sh.value("output", "split") == "merge")
+    {
+        // shards feed one event-time ordered stream into the main pipeline and its sinks
+        shardMerge = std::make_unique<StagingBackend>(*logger, buffer_capacity, std::chrono::milliseconds(10),
+                                                      true, sh.value("merge_grace_ms", 50));
+        for (size_t i = 0; i < shards->size(); ++i)
+            shards->shard(i).add_sink(std::make_unique<StagingSinkImpl>(*shardMerge));
+        shardMerge->start();
+        return;
+    }
+
+    // split: every shard writes its own files ("output.shard0.log", segments prefix "output.shard0")
+    bool reorder = config["log_manager"].contains("reorder") && config["log_manager"]["reorder"].value("enabled", false);
+    for (size_t i = 0; i < shards->size(); ++i)
+    {
+        std::vector<std::unique_ptr<ILogSink>> shardSinks;
+        setupSinks(shardSinks, config["sinks"], ".shard" + std::to_string(i));
+        setupNodeSinks(shardSinks, ".shard" + std::to_string(i));
+        for (auto &sink : shardSinks)
+            shards->shard(i).add_sink(std::move(sink));
+
+        if (reorder)
+            shards->shard(i).enable_reorder(config["log_manager"]["reorder"].value("lateness_ms", 2000),
+                                            config["log_manager"]["reorder"].value("capacity", 1024));
     }
 }
 
@@ -172,28 +624,111 @@ void TelemetryLoggingApp::startWriterThread()
 {
     writerThread_ = std::thread([this]()
     {
+        auto next_report = std::chrono::steady_clock::now() + std::chrono::milliseconds(hot_report_ms);
+        std::vector<LogMessage> stale;
+        auto reportHot = [this]()
+        {
+            for (auto &msg : hotSources->report())
+                route(std::move(msg)); // not counted as a source itself
+        };
+
         while (isRunning)
         {
             std::this_thread::sleep_for(std::chrono::milliseconds(sink_flush_rate_ms));
+            if (hotSources && std::chrono::steady_clock::now() >= next_report)
+            {
+                reportHot();
+                next_report += std::chrono::milliseconds(hot_report_ms);
+            }
+            if (liveness)
+            {
+                stale.clear();
+                liveness->tick(wallClockMs(), stale);
+                for (auto &msg : stale)
+                    route(std::move(msg));
+            }
+            if (shards)
+                for (size_t i = 0; i < shards->size(); ++i)
+                    shards->shard(i).write();
+            if (pipeline)
+                pipeline->tick();
             logger->write(); // flush messages to sinks
         }
-        logger->write(); // flush remaining messages on shutdown
+        if (hotSources)
+            reportHot(); // the partial interval
+        if (shards)
+            shards->flush();
+        if (staging)
+            staging->stop(); // queued messages reach logger before its final flush
+        if (shardMerge)
+            shardMerge->stop(); // everything merged into logger before its final flush
+        logger->flush(); // flush remaining messages on shutdown
+        if (size_t late = logger->late_count())
+            std::cout << "[LogManager] " << late << " late arrivals behind the watermark\n";
     });
 }
 
+void TelemetryLoggingApp::startMaintenance()
+{
+    if (!config.contains("maintenance") || !config["maintenance"].value("enabled", false))
+        return;
+    if (!config["sinks"].contains("segments") || !config["sinks"]["segments"].value("enabled", false))
+    {
+        std::cout << "[LogMaintenance] needs sinks.segments enabled, skipped\n";
+        return;
+    }
+
+    auto &m = config["maintenance"];
+    auto &seg = config["sinks"]["segments"];
+
+    MaintenanceConfig cfg;
+    cfg.dir = seg.value("dir", "logs/segments");
+    cfg.prefix = seg.value("prefix", "output");
+    cfg.period_ms = static_cast<int64_t>(seg.value("segment_minutes", 60)) * 60 * 1000;
+    cfg.interval_s = m.value("interval_s", 60);
+    cfg.max_age_ms = static_cast<int64_t>(m.value("max_age_hours", 0)) * 3600 * 1000;
+    cfg.max_total_bytes = static_cast<uint64_t>(m.value("max_total_mb", 0)) << 20;
+    cfg.downsample_after_ms = static_cast<int64_t>(m.value("downsample_after_hours", 0)) * 3600 * 1000;
+    cfg.compact_below_bytes = static_cast<uint64_t>(m.value("compact_below_kb", 0)) << 10;
+    cfg.io_bytes_per_s = m.value("io_rate_kb_s", 4096) * 1024.0;
+    cfg.idle_io_priority = m.value("idle_io_priority", true);
+
+    maintenance = std::make_unique<LogMaintenance>(cfg);
+    maintenance->start();
+}
+
 void TelemetryLoggingApp::signalHandler(int signal)
 {
-    if (g_app_instance)
-        g_app_instance->isRunning = false;
-    exit(0);
+    // first signal: stop the sources and let start() return so the pipeline drains,
+    // second signal: leave at once (a source stuck in a blocking read)
+    if (g_app_instance && g_app_instance->isRunning.exchange(false))
+        return;
+    std::_Exit(0);
 }
 
 void TelemetryLoggingApp::start()
 {
     isRunning = true;
 
+    if (config["log_manager"].contains("shards") && config["log_manager"]["shards"].value("enabled", false))
+        setupShards();
+
+    // central instance: merge the summaries edge nodes send
+    if (config.contains("central") && config["central"].value("enabled", false))
+    {
+        summaries = std::make_unique<SummaryReceiver>(*logger, config["central"].value("port", 24000),
+                                                      static_cast<int64_t>(config["central"].value("grace_s", 5)) * 1000);
+        summaries->start();
+    }
+
+    if (tail)
+        tail->start();
+
     // writer thread
     startWriterThread();
+    if (staging)
+        staging->start();
+    startMaintenance();
     setupTelemetrySources();
 
     // join all threads (blocking main)
@@ -202,4 +737,23 @@ void TelemetryLoggingApp::start()
             t.join();
     if (writerThread_.joinable())
         writerThread_.join();
+    if (pipeline)
+        pipeline->stop(); // sources are done, drain the stages
 }
+
+
+void TelemetryLoggingApp::reprocess(const std::vector<std::string> &paths)
+{
+    size_t threads = config.contains("reprocess") ? config["reprocess"].value("threads", 0) : 0;
+    size_t chunk_mb = config.contains("reprocess") ? config["reprocess"].value("chunk_mb", 32) : 32;
+    bool reclassify = config.contains("reprocess") ? config["reprocess"].value("reclassify", true) : true;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    LogReprocessor reprocessor(*logger, threads, chunk_mb << 20, reclassify);
+    auto stats = reprocessor.run(paths);
+
+    std::cout << "[Reprocess] " << stats.records << " records, " << stats.rejected << " rejected, "
+              << stats.bytes << " bytes in " << stats.seconds << " s ("
+              << (stats.seconds > 0 ? stats.bytes / stats.seconds / 1e9 : 0.0) << " GB/s)\n";
+}
\ No newline at end of file
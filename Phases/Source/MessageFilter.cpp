@@ -0,0 +1,143 @@
+#include "MessageFilter.hpp"
+#include "magic_enum/magic_enum.hpp"
+
+#include <charconv>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    std::vector<std::string> splitList(const std::string &value)
+    {
+        std::vector<std::string> items;
+        std::stringstream ss(value);
+        std::string item;
+        while (std::getline(ss, item, ','))
+            if (!item.empty())
+                items.push_back(item);
+        return items;
+    }
+
+    std::optional<float> parseFloat(const std::string &value)
+    {
+        try
+        {
+            size_t used;
+            float v = std::stof(value, &used);
+            if (used == value.size())
+                return v;
+        }
+        catch (const std::exception &)
+        {
+        }
+        return std::nullopt;
+    }
+
+    // shortest text that reads back as the same float, distinct bounds never share a key
+    std::string exactText(float v)
+    {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), v);
+        return std::string(buffer, result.ptr);
+    }
+}
+
+std::optional<MessageFilter> MessageFilter::parse(const std::string &line, std::string &error)
+{
+    MessageFilter filter;
+    std::stringstream ss(line);
+    std::string token;
+    while (ss >> token)
+    {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos)
+        {
+            error = "expected key=value: " + token;
+            return std::nullopt;
+        }
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+
+        if (key == "level" || key == "min_level")
+        {
+            uint32_t mask = 0;
+            for (const auto &name : splitList(value))
+            {
+                auto level = magic_enum::enum_cast<severity_level>(name);
+                if (!level)
+                {
+                    error = "unknown level: " + name;
+                    return std::nullopt;
+                }
+                if (key == "level")
+                    mask |= 1u << static_cast<uint32_t>(*level);
+                else
+                    for (auto other : magic_enum::enum_values<severity_level>())
+                        if (severityRank(other) >= severityRank(*level))
+                            mask |= 1u << static_cast<uint32_t>(other);
+            }
+            filter.severity_mask &= mask;
+        }
+        else if (key == "context" || key == "app")
+        {
+            auto &set = key == "context" ? filter.contexts : filter.apps;
+            for (auto &item : splitList(value))
+                set.insert(std::move(item));
+        }
+        else if (key == "min" || key == "max")
+        {
+            auto v = parseFloat(value);
+            if (!v)
+            {
+                error = "not a number: " + value;
+                return std::nullopt;
+            }
+            (key == "min" ? filter.min_value : filter.max_value) = v;
+        }
+        else
+        {
+            error = "unknown key: " + key;
+            return std::nullopt;
+        }
+    }
+    return filter;
+}
+
+std::string MessageFilter::key() const
+{
+    std::string key = "levels=" + std::to_string(severity_mask & ((1u << magic_enum::enum_count<severity_level>()) - 1));
+    auto list = [&key](const char *name, const std::set<std::string> &items)
+    {
+        if (items.empty())
+            return;
+        key += std::string(" ") + name + "=";
+        for (const auto &item : items)
+            key += item + ",";
+        key.pop_back();
+    };
+    list("context", contexts);
+    list("app", apps);
+    if (min_value)
+        key += " min=" + exactText(*min_value);
+    if (max_value)
+        key += " max=" + exactText(*max_value);
+    return key;
+}
+
+bool MessageFilter::matches(const LogMessage &message, const std::optional<float> &value) const
+{
+    if (!(severity_mask & (1u << static_cast<uint32_t>(message.level))))
+        return false;
+    if (!contexts.empty() && !contexts.count(message.context))
+        return false;
+    if (!apps.empty() && !apps.count(message.app_name))
+        return false;
+    if (needsValue())
+    {
+        if (!value)
+            return false;
+        if ((min_value && *value < *min_value) || (max_value && *value > *max_value))
+            return false;
+    }
+    return true;
+}
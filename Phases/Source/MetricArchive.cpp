@@ -0,0 +1,142 @@
+#include "MetricArchive.hpp"
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+size_t MetricArchive::fileSize(const std::vector<Resolution> &layout)
+{
+    // every slot computation divides by step_ms and rows
+    for (const auto &res : layout)
+        if (res.step_ms <= 0 || res.rows == 0)
+            throw std::runtime_error("Invalid archive resolution: step_ms " + std::to_string(res.step_ms) +
+                                     ", rows " + std::to_string(res.rows));
+
+    size_t size = sizeof(Header) + layout.size() * sizeof(Resolution);
+    for (const auto &res : layout)
+        size += static_cast<size_t>(res.rows) * sizeof(Cell);
+    return size;
+}
+
+std::vector<MetricArchive::Resolution> MetricArchive::defaultLayout()
+{
+    return {{1000, 3600, 0}, {60 * 1000, 7 * 24 * 60, 0}, {3600 * 1000, 365 * 24, 0}};
+}
+
+MetricArchive::MetricArchive(const std::string &path, std::vector<Resolution> layout)
+    : file(path, fileSize(layout)), resolutions(std::move(layout))
+{
+    if (!layoutMatches())
+        format();
+    bind();
+}
+
+MetricArchive::MetricArchive(const std::string &path)
+    : file(path)
+{
+    std::string_view bytes = file.view();
+    Header header;
+    if (bytes.size() < sizeof(Header))
+        throw std::runtime_error("Not a metric archive: " + path);
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("Not a metric archive: " + path);
+
+    auto *stored = reinterpret_cast<const Resolution *>(bytes.data() + sizeof(Header));
+    resolutions.assign(stored, stored + header.resolution_count);
+    if (fileSize(resolutions) > bytes.size())
+        throw std::runtime_error("Truncated metric archive: " + path);
+    bind();
+}
+
+bool MetricArchive::layoutMatches() const
+{
+    std::string_view bytes = file.view();
+    const auto *header = reinterpret_cast<const Header *>(bytes.data());
+    if (std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->resolution_count != resolutions.size())
+        return false;
+
+    const auto *stored = reinterpret_cast<const Resolution *>(bytes.data() + sizeof(Header));
+    for (size_t i = 0; i < resolutions.size(); ++i)
+        if (stored[i].step_ms != resolutions[i].step_ms || stored[i].rows != resolutions[i].rows)
+            return false;
+    return true;
+}
+
+void MetricArchive::format()
+{
+    char *base = file.writable();
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = 1;
+    header.resolution_count = static_cast<uint32_t>(resolutions.size());
+    std::memcpy(base, &header, sizeof(header));
+    std::memcpy(base + sizeof(Header), resolutions.data(), resolutions.size() * sizeof(Resolution));
+
+    Cell empty{-1, 0, 0, 0, 0, 0};
+    Cell *cell = reinterpret_cast<Cell *>(base + sizeof(Header) + resolutions.size() * sizeof(Resolution));
+    for (const auto &res : resolutions)
+        for (uint32_t i = 0; i < res.rows; ++i)
+            *cell++ = empty;
+}
+
+void MetricArchive::bind()
+{
+    // Header, Resolution and Cell are all multiples of 8 bytes, so cells stay aligned
+    char *cursor = const_cast<char *>(file.view().data()) + sizeof(Header) + resolutions.size() * sizeof(Resolution);
+    rings.clear();
+    for (const auto &res : resolutions)
+    {
+        rings.push_back(reinterpret_cast<Cell *>(cursor));
+        cursor += static_cast<size_t>(res.rows) * sizeof(Cell);
+    }
+}
+
+void MetricArchive::update(int64_t time_ms, float value)
+{
+    if (time_ms < 0)
+        return; // slots are non-negative, a ring index must never wrap below 0
+    for (size_t r = 0; r < resolutions.size(); ++r)
+    {
+        int64_t slot = time_ms / resolutions[r].step_ms;
+        Cell &cell = rings[r][slot % resolutions[r].rows];
+
+        if (cell.slot != slot)
+        {
+            if (cell.slot > slot)
+                continue; // older than what the ring holds now
+            cell = Cell{slot, value, value, 0, 0, 0};
+        }
+
+        cell.min = std::min(cell.min, value);
+        cell.max = std::max(cell.max, value);
+        cell.sum += value;
+        ++cell.count;
+    }
+}
+
+std::vector<MetricArchive::Point> MetricArchive::query(int64_t from_ms, int64_t to_ms, int64_t now_ms) const
+{
+    std::vector<Point> points;
+    if (resolutions.empty() || to_ms < 0 || now_ms < 0)
+        return points;
+    from_ms = std::max<int64_t>(from_ms, 0);
+
+    size_t r = 0;
+    while (r + 1 < resolutions.size() && now_ms - resolutions[r].step_ms * resolutions[r].rows > from_ms)
+        ++r;
+
+    const Resolution &res = resolutions[r];
+    int64_t first = std::max(from_ms, now_ms - res.step_ms * (res.rows - 1)) / res.step_ms;
+    int64_t last = std::min(to_ms, now_ms) / res.step_ms;
+
+    for (int64_t slot = first; slot <= last; ++slot)
+    {
+        const Cell &cell = rings[r][slot % res.rows];
+        if (cell.slot != slot || cell.count == 0)
+            continue;
+        points.push_back({slot * res.step_ms, cell.min, cell.max, cell.sum / cell.count, cell.count});
+    }
+    return points;
+}
@@ -0,0 +1,250 @@
+#include "MetricSummary.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t frame_magic = 0x4d53554d; // "MUSM"
+    constexpr double min_value = 1e-9;
+    constexpr size_t max_frame = 1 << 20;
+
+    template <typename T>
+    void put(std::string &out, T value)
+    {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool get(std::string_view &in, T &value)
+    {
+        if (in.size() < sizeof(value))
+            return false;
+        std::memcpy(&value, in.data(), sizeof(value));
+        in.remove_prefix(sizeof(value));
+        return true;
+    }
+
+    bool getString(std::string_view &in, std::string &value)
+    {
+        uint16_t length;
+        if (!get(in, length) || in.size() < length)
+            return false;
+        value.assign(in.data(), length);
+        in.remove_prefix(length);
+        return true;
+    }
+}
+
+int32_t QuantileSketch::bucketOf(double value)
+{
+    static const double log_gamma = std::log((1 + alpha) / (1 - alpha));
+    return static_cast<int32_t>(std::ceil(std::log(value) / log_gamma));
+}
+
+double QuantileSketch::valueOf(int32_t index)
+{
+    static const double gamma = (1 + alpha) / (1 - alpha);
+    return 2 * std::pow(gamma, index) / (gamma + 1);
+}
+
+void QuantileSketch::add(double value, uint64_t count)
+{
+    if (value <= min_value)
+    {
+        zero_count += count;
+        return;
+    }
+
+    int32_t index = bucketOf(value);
+    auto it = std::lower_bound(buckets.begin(), buckets.end(), index, [](const auto &bucket, int32_t i)
+                               { return bucket.first < i; });
+    if (it != buckets.end() && it->first == index)
+        it->second += count;
+    else
+        buckets.insert(it, {index, count});
+}
+
+void QuantileSketch::merge(const QuantileSketch &other)
+{
+    zero_count += other.zero_count;
+
+    std::vector<std::pair<int32_t, uint64_t>> merged;
+    merged.reserve(buckets.size() + other.buckets.size());
+    auto a = buckets.begin();
+    auto b = other.buckets.begin();
+    while (a != buckets.end() || b != other.buckets.end())
+    {
+        if (b == other.buckets.end() || (a != buckets.end() && a->first < b->first))
+            merged.push_back(*a++);
+        else if (a == buckets.end() || b->first < a->first)
+            merged.push_back(*b++);
+        else
+        {
+            merged.emplace_back(a->first, a->second + b->second);
+            ++a;
+            ++b;
+        }
+    }
+    buckets.swap(merged);
+}
+
+uint64_t QuantileSketch::count() const
+{
+    uint64_t total = zero_count;
+    for (const auto &bucket : buckets)
+        total += bucket.second;
+    return total;
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    uint64_t total = count();
+    if (total == 0)
+        return 0;
+
+    double rank = q * (total - 1);
+    uint64_t seen = zero_count;
+    if (seen > rank)
+        return 0;
+    for (const auto &bucket : buckets)
+    {
+        seen += bucket.second;
+        if (seen > rank)
+            return valueOf(bucket.first);
+    }
+    return valueOf(buckets.back().first);
+}
+
+void MetricSummary::add(float value, severity_level level)
+{
+    min = count ? std::min(min, value) : value;
+    max = count ? std::max(max, value) : value;
+    sum += value;
+    ++count;
+    ++severity_counts[static_cast<size_t>(level) % severity_counts.size()];
+    sketch.add(value);
+}
+
+void MetricSummary::merge(const MetricSummary &other)
+{
+    if (other.count == 0)
+        return;
+
+    min = count ? std::min(min, other.min) : other.min;
+    max = count ? std::max(max, other.max) : other.max;
+    sum += other.sum;
+    count += other.count;
+    for (size_t i = 0; i < severity_counts.size(); ++i)
+        severity_counts[i] += other.severity_counts[i];
+    sketch.merge(other.sketch);
+}
+
+severity_level MetricSummary::worst() const
+{
+    if (severity_counts[static_cast<size_t>(severity_level::Critical)])
+        return severity_level::Critical;
+    if (severity_counts[static_cast<size_t>(severity_level::Warning)])
+        return severity_level::Warning;
+    return severity_level::Info;
+}
+
+std::string MetricSummary::describe() const
+{
+    return "count=" + std::to_string(count) +
+           " min=" + std::to_string(min) +
+           " max=" + std::to_string(max) +
+           " avg=" + std::to_string(count ? sum / count : 0.0) +
+           " p50=" + std::to_string(sketch.quantile(0.5)) +
+           " p95=" + std::to_string(sketch.quantile(0.95)) +
+           " p99=" + std::to_string(sketch.quantile(0.99)) +
+           " warning=" + std::to_string(severity_counts[static_cast<size_t>(severity_level::Warning)]) +
+           " critical=" + std::to_string(severity_counts[static_cast<size_t>(severity_level::Critical)]);
+}
+
+LogMessage MetricSummary::toLogMessage() const
+{
+    LogMessage msg{"summary", context, describe(), worst(), formatTimeStamp(window_start_ms)};
+    if (app_name != context)
+        msg.context = app_name + "/" + context;
+    msg.event_time_ms = window_start_ms;
+    return msg;
+}
+
+void MetricSummary::serialize(std::string &out) const
+{
+    size_t start = out.size();
+    put<uint32_t>(out, 0); // size, patched below
+    put(out, frame_magic);
+
+    put(out, static_cast<uint16_t>(std::min<size_t>(app_name.size(), UINT16_MAX)));
+    out.append(app_name, 0, UINT16_MAX);
+    put(out, static_cast<uint16_t>(std::min<size_t>(context.size(), UINT16_MAX)));
+    out.append(context, 0, UINT16_MAX);
+
+    put(out, window_start_ms);
+    put(out, window_ms);
+    put(out, count);
+    put(out, min);
+    put(out, max);
+    put(out, sum);
+    for (uint64_t n : severity_counts)
+        put(out, n);
+
+    put(out, sketch.zero_count);
+    put(out, static_cast<uint32_t>(sketch.buckets.size()));
+    for (const auto &[index, n] : sketch.buckets)
+    {
+        put(out, index);
+        put(out, n);
+    }
+
+    uint32_t size = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+    std::memcpy(&out[start], &size, sizeof(size));
+}
+
+std::optional<MetricSummary> MetricSummary::deserialize(std::string_view data, size_t &used)
+{
+    used = 0;
+    uint32_t size;
+    if (!get(data, size))
+        return std::nullopt;
+    if (size > max_frame)
+    {
+        used = data.size() + sizeof(size); // garbage, drop everything buffered
+        return std::nullopt;
+    }
+    if (data.size() < size)
+        return std::nullopt; // incomplete
+
+    used = sizeof(size) + size;
+    std::string_view in = data.substr(0, size);
+
+    MetricSummary summary;
+    uint32_t magic;
+    uint32_t bucket_count;
+    if (!get(in, magic) || magic != frame_magic ||
+        !getString(in, summary.app_name) || !getString(in, summary.context) ||
+        !get(in, summary.window_start_ms) || !get(in, summary.window_ms) ||
+        !get(in, summary.count) || !get(in, summary.min) || !get(in, summary.max) || !get(in, summary.sum))
+        return std::nullopt;
+    for (uint64_t &n : summary.severity_counts)
+        if (!get(in, n))
+            return std::nullopt;
+    if (!get(in, summary.sketch.zero_count) || !get(in, bucket_count) || in.size() != bucket_count * 12ull)
+        return std::nullopt;
+
+    summary.sketch.buckets.resize(bucket_count);
+    for (auto &[index, n] : summary.sketch.buckets)
+    {
+        get(in, index);
+        get(in, n);
+    }
+
+    // merge relies on strictly increasing bucket indices
+    for (size_t i = 1; i < summary.sketch.buckets.size(); ++i)
+        if (summary.sketch.buckets[i - 1].first >= summary.sketch.buckets[i].first)
+            return std::nullopt;
+    return summary;
+}
@@ -0,0 +1,63 @@
+#include "ReorderBuffer.hpp"
+#include <algorithm>
+
+namespace
+{
+    struct Later
+    {
+        template <typename E>
+        bool operator()(const E &a, const E &b) const
+        {
+            return a.time != b.time ? a.time > b.time : a.seq > b.seq;
+        }
+    };
+}
+
+ReorderBuffer::ReorderBuffer(int64_t lateness_ms, size_t capacity)
+    : lateness_ms(lateness_ms), capacity(capacity)
+{
+    heap.reserve(capacity + 1);
+}
+
+void ReorderBuffer::push(LogMessage msg)
+{
+    int64_t time = msg.event_time_ms;
+
+    if (time < last_released)
+        ++late;
+    max_seen = std::max(max_seen, time);
+
+    heap.push_back(Entry{time, next_seq++, std::move(msg)});
+    std::push_heap(heap.begin(), heap.end(), Later{});
+}
+
+LogMessage ReorderBuffer::popTop()
+{
+    std::pop_heap(heap.begin(), heap.end(), Later{});
+    Entry top = std::move(heap.back());
+    heap.pop_back();
+
+    last_released = std::max(last_released, top.time);
+    return std::move(top.msg);
+}
+
+std::optional<LogMessage> ReorderBuffer::popReady(int64_t now_ms)
+{
+    if (heap.empty())
+        return std::nullopt;
+
+    // wall clock keeps the watermark moving when sources go quiet
+    int64_t watermark = std::max(max_seen, now_ms) - lateness_ms;
+
+    if (heap.front().time <= watermark || heap.size() > capacity || heap.front().time < last_released)
+        return popTop();
+
+    return std::nullopt;
+}
+
+std::optional<LogMessage> ReorderBuffer::popAny()
+{
+    if (heap.empty())
+        return std::nullopt;
+    return popTop();
+}
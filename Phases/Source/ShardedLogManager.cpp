@@ -0,0 +1,53 @@
+#include "ShardedLogManager.hpp"
+#include <functional>
+#include <thread>
+
+ShardedLogManager::ShardedLogManager(size_t shard_count, size_t capacity, bool pin_cores)
+{
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    if (shard_count == 0)
+        shard_count = cores;
+
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        // one writer per shard: sink output stays ordered without sharing
+        shards.push_back(std::make_unique<LogManager>(1, capacity, pin_cores ? static_cast<int>(i % cores) : -1));
+    }
+}
+
+void ShardedLogManager::assign(const std::string &key, size_t shard)
+{
+    assignment[key] = shard % shards.size();
+    source_assignment[sourceKey(key)] = shard % shards.size();
+}
+
+size_t ShardedLogManager::shardFor(const LogMessage &message) const
+{
+    if (!assignment.empty())
+    {
+        if (message.source_key)
+            if (auto source = source_assignment.find(message.source_key); source != source_assignment.end())
+                return source->second;
+        auto it = assignment.find(message.app_name);
+        if (it == assignment.end())
+            it = assignment.find(message.context);
+        if (it != assignment.end())
+            return it->second;
+    }
+
+    if (message.source_key)
+        return message.source_key % shards.size();
+    size_t hash = std::hash<std::string_view>{}(message.app_name) * 31 + std::hash<std::string_view>{}(message.context);
+    return hash % shards.size();
+}
+
+void ShardedLogManager::log(const LogMessage &message)
+{
+    shards[shardFor(message)]->log(message);
+}
+
+void ShardedLogManager::flush()
+{
+    for (auto &shard : shards)
+        shard->flush();
+}
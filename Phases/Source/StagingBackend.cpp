@@ -0,0 +1,212 @@
+#include "StagingBackend.hpp"
+#include <algorithm>
+
+namespace
+{
+    std::atomic<uint64_t> next_backend_id{1};
+    constexpr size_t handover_batch = 256; // messages per log_batch call, unless the ring is smaller
+
+    // queues of this thread, one per backend it logged through
+    struct LocalQueues
+    {
+        std::vector<std::pair<uint64_t, std::shared_ptr<StagingBackend::Queue>>> entries;
+
+        ~LocalQueues()
+        {
+            for (auto &entry : entries)
+                entry.second->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+StagingBackend::StagingBackend(LogManager &manager, size_t queue_capacity, std::chrono::milliseconds poll_interval,
+                               bool ordered_merge, int64_t merge_grace_ms)
+    : manager(manager), queue_capacity(std::max<size_t>(queue_capacity, 2)), poll_interval(poll_interval),
+      ordered_merge(ordered_merge), merge_grace_ms(merge_grace_ms), id(next_backend_id++),
+      handover(std::max<size_t>(std::min(handover_batch, manager.capacity()), 1))
+{
+}
+
+StagingBackend::~StagingBackend()
+{
+    stop();
+}
+
+StagingBackend::Queue &StagingBackend::localQueue()
+{
+    thread_local LocalQueues local;
+
+    for (auto &entry : local.entries)
+        if (entry.first == id)
+            return *entry.second;
+
+    auto queue = std::make_shared<Queue>(queue_capacity);
+    {
+        std::lock_guard<std::mutex> lock(queues_mtx);
+        queues.push_back(queue);
+    }
+    local.entries.emplace_back(id, queue);
+    return *queue;
+}
+
+bool StagingBackend::log(LogMessage message, bool wait)
+{
+    Queue &queue = localQueue();
+    if (queue.messages.tryPush(std::move(message))) // moves only on success
+        return true;
+    while (wait && draining.load(std::memory_order_acquire))
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        if (queue.messages.tryPush(std::move(message)))
+            return true;
+    }
+    queue.dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void StagingBackend::start()
+{
+    draining.store(true, std::memory_order_release);
+    worker = std::thread([this]()
+                         { run(); });
+}
+
+void StagingBackend::stop()
+{
+    draining.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop_flag = true;
+    }
+    cv.notify_all();
+    if (worker.joinable())
+        worker.join();
+    poll(true);
+}
+
+void StagingBackend::run()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stop_flag)
+    {
+        lock.unlock();
+        size_t moved = poll();
+        lock.lock();
+
+        if (moved == 0)
+            cv.wait_for(lock, poll_interval, [this]()
+                        { return stop_flag; });
+    }
+}
+
+size_t StagingBackend::poll(bool final_pass)
+{
+    std::vector<std::shared_ptr<Queue>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(queues_mtx);
+        snapshot = queues;
+    }
+
+    // retired before draining: nothing can be pushed after the flag is seen
+    std::vector<bool> retired(snapshot.size());
+    for (size_t i = 0; i < snapshot.size(); ++i)
+        retired[i] = snapshot[i]->retired.load(std::memory_order_acquire);
+
+    size_t moved = ordered_merge ? drainOrdered(snapshot, final_pass ? INT64_MAX : nowMs() - merge_grace_ms)
+                                 : drainUnordered(snapshot);
+
+    uint64_t dropped = 0;
+    for (auto &queue : snapshot)
+        dropped += queue->dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0)
+        std::cout << "[StagingBackend] queue full, " << dropped << " messages dropped\n";
+
+    std::vector<std::shared_ptr<Queue>> finished;
+    for (size_t i = 0; i < snapshot.size(); ++i)
+        if (retired[i] && snapshot[i]->messages.front() == nullptr)
+            finished.push_back(snapshot[i]);
+    if (!finished.empty())
+    {
+        std::lock_guard<std::mutex> lock(queues_mtx);
+        queues.erase(std::remove_if(queues.begin(), queues.end(), [&finished](const auto &queue)
+                                    { return std::find(finished.begin(), finished.end(), queue) != finished.end(); }),
+                     queues.end());
+    }
+
+    return moved;
+}
+
+size_t StagingBackend::drainUnordered(std::vector<std::shared_ptr<Queue>> &snapshot)
+{
+    size_t moved = 0;
+    for (auto &queue : snapshot)
+    {
+        // at most one queue's worth per pass, a busy producer cannot starve the others
+        size_t budget = queue->messages.max_size();
+        while (LogMessage *msg = budget-- ? queue->messages.front() : nullptr)
+        {
+            batch.push_back(std::move(*msg));
+            queue->messages.pop();
+
+            if (batch.size() >= handover)
+            {
+                moved += batch.size();
+                manager.log_batch(batch);
+                batch.clear();
+            }
+        }
+    }
+
+    moved += batch.size();
+    manager.log_batch(batch);
+    batch.clear();
+    return moved;
+}
+
+size_t StagingBackend::drainOrdered(std::vector<std::shared_ptr<Queue>> &snapshot, int64_t cutoff_ms)
+{
+    size_t moved = 0;
+    size_t budget = 0;
+    for (auto &queue : snapshot)
+        budget += queue->messages.max_size();
+
+    while (budget-- > 0)
+    {
+        // k-way merge over the queue fronts, k is the number of producer threads
+        Queue *oldest = nullptr;
+        int64_t oldest_ms = cutoff_ms;
+        for (auto &queue : snapshot)
+        {
+            LogMessage *msg = queue->messages.front();
+            if (msg && msg->event_time_ms <= oldest_ms)
+            {
+                oldest = queue.get();
+                oldest_ms = msg->event_time_ms;
+            }
+        }
+        if (!oldest)
+            break;
+
+        batch.push_back(std::move(*oldest->messages.front()));
+        oldest->messages.pop();
+
+        if (batch.size() >= handover)
+        {
+            moved += batch.size();
+            manager.log_batch(batch);
+            batch.clear();
+        }
+    }
+
+    moved += batch.size();
+    manager.log_batch(batch);
+    batch.clear();
+    return moved;
+}
@@ -0,0 +1,87 @@
+#include "StaleSources.hpp"
+#include <algorithm>
+
+StaleSources::StaleSources(int64_t timeout_ms, int64_t tick_ms, int64_t now_ms)
+    : timeout_ms(std::max<int64_t>(timeout_ms, 1)), tick_ms(std::max<int64_t>(tick_ms, 1)), origin_ms(now_ms)
+{
+}
+
+LogMessage StaleSources::record(const Source &source, severity_level level, const std::string &text,
+                                int64_t now_ms) const
+{
+    LogMessage msg{source.name, "liveness", text, level, formatTimeStamp(now_ms)};
+    msg.event_time_ms = now_ms;
+    return msg;
+}
+
+void StaleSources::add(const std::string &name, int64_t now_ms)
+{
+    TimerWheel::Handle h = wheel.add();
+    ids.emplace(name, h);
+    sources.push_back({name, now_ms, 0});
+    wheel.arm(h, tickOf(now_ms + timeout_ms));
+}
+
+void StaleSources::watch(const std::string &name, int64_t now_ms)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!ids.contains(name))
+        add(name, now_ms);
+}
+
+std::optional<LogMessage> StaleSources::seen(const std::string &name, int64_t now_ms)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = ids.find(name);
+    if (it == ids.end())
+    {
+        add(name, now_ms);
+        return std::nullopt;
+    }
+
+    TimerWheel::Handle h = it->second;
+    Source &source = sources[h];
+    source.last_seen_ms = std::max(source.last_seen_ms, now_ms);
+    if (source.stale_since_ms == 0)
+        return std::nullopt; // timer still armed, checked when it fires
+
+    int64_t silent = now_ms - source.stale_since_ms + timeout_ms;
+    source.stale_since_ms = 0;
+    --stale;
+    wheel.arm(h, tickOf(now_ms + timeout_ms));
+    return record(source, severity_level::Info, "Recovered: silent for " + std::to_string(silent) + " ms", now_ms);
+}
+
+void StaleSources::tick(int64_t now_ms, std::vector<LogMessage> &out)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // a timer fires at the end of its tick, so one tick of lateness at most
+    uint64_t target = now_ms > origin_ms ? static_cast<uint64_t>((now_ms - origin_ms) / tick_ms) : 0;
+    wheel.advance(target, [&](TimerWheel::Handle h)
+                  {
+        Source &source = sources[h];
+        int64_t deadline = source.last_seen_ms + timeout_ms;
+        if (deadline > now_ms)
+        {
+            wheel.arm(h, tickOf(deadline)); // samples arrived since it was armed
+            return;
+        }
+        source.stale_since_ms = deadline;
+        ++stale;
+        out.push_back(record(source, severity_level::Critical,
+                             "Stale: no data for " + std::to_string(now_ms - source.last_seen_ms) + " ms", now_ms)); });
+}
+
+size_t StaleSources::size()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return sources.size();
+}
+
+size_t StaleSources::staleCount()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return stale;
+}
@@ -0,0 +1,225 @@
+#include "SummaryReceiver.hpp"
+#include "DeliveryFrame.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace
+{
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    struct Client
+    {
+        int fd;
+        std::string buffer;
+        uint64_t sender = 0; // from the hello frame
+        uint64_t acked = 0;  // last ack written to this connection
+    };
+}
+
+SummaryReceiver::SummaryReceiver(LogManager &manager, uint16_t port, int64_t grace_ms)
+    : manager(manager), port(port), grace_ms(grace_ms)
+{
+    listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1)
+        throw std::runtime_error("Failed to create socket: " + std::string(std::strerror(errno)));
+
+    int on = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (::bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 || ::listen(listen_fd, 64) == -1)
+    {
+        ::close(listen_fd);
+        throw std::runtime_error("Failed to listen on " + std::to_string(port) + ": " + std::strerror(errno));
+    }
+}
+
+SummaryReceiver::~SummaryReceiver()
+{
+    stop();
+    ::close(listen_fd);
+}
+
+void SummaryReceiver::start()
+{
+    running = true;
+    worker = std::thread([this]()
+                         { run(); });
+}
+
+void SummaryReceiver::stop()
+{
+    running = false;
+    if (worker.joinable())
+    {
+        worker.join();
+        std::cout << "[SummaryReceiver] " << received << " summaries merged, " << late
+                  << " late for windows already logged\n";
+    }
+}
+
+void SummaryReceiver::run()
+{
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    char chunk[16384];
+
+    // one last pass after stop(): log every window and acknowledge it before disconnecting
+    for (bool stopping = false; !stopping;)
+    {
+        stopping = !running;
+        fds.clear();
+        fds.push_back({listen_fd, POLLIN, 0});
+        for (const auto &client : clients)
+            fds.push_back({client.fd, POLLIN, 0});
+
+        int ready = ::poll(fds.data(), fds.size(), stopping ? 0 : 200);
+        if (ready > 0 && (fds[0].revents & POLLIN))
+        {
+            int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd != -1)
+                clients.push_back({fd, {}, 0, 0});
+        }
+
+        for (size_t i = 1; ready > 0 && i < fds.size(); ++i)
+        {
+            if (!fds[i].revents)
+                continue;
+
+            Client &client = clients[i - 1];
+            ssize_t n = ::recv(client.fd, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+            {
+                ::close(client.fd);
+                client.fd = -1; // a partial frame in the buffer is dropped with it
+                continue;
+            }
+
+            client.buffer.append(chunk, static_cast<size_t>(n));
+            size_t pos = 0;
+            while (true)
+            {
+                size_t used;
+                auto frame = DeliveryFrame::parse(std::string_view(client.buffer).substr(pos), used);
+                if (used == 0)
+                    break;
+                pos += used;
+                if (!frame)
+                    continue;
+
+                if (frame->type == DeliveryFrame::Type::Hello)
+                {
+                    client.sender = frame->value;
+                    client.acked = senders[client.sender].acked;
+                }
+                else if (client.sender != 0)
+                    onRecord(senders[client.sender], frame->value, frame->payload, nowMs());
+            }
+            client.buffer.erase(0, std::min(pos, client.buffer.size()));
+        }
+
+        clients.erase(std::remove_if(clients.begin(), clients.end(), [](const Client &c)
+                                     { return c.fd == -1; }),
+                      clients.end());
+
+        emitClosed(nowMs(), stopping);
+
+        // acknowledge what is logged now, replays of anything older are skipped by seq
+        for (auto &client : clients)
+        {
+            if (client.sender == 0)
+                continue;
+            uint64_t seq = ackable(senders[client.sender]);
+            if (seq > client.acked &&
+                ::send(client.fd, &seq, sizeof(seq), MSG_NOSIGNAL | MSG_DONTWAIT) == sizeof(seq))
+                client.acked = seq;
+        }
+    }
+
+    for (auto &client : clients)
+        ::close(client.fd);
+}
+
+void SummaryReceiver::onRecord(Sender &sender, uint64_t seq, std::string_view payload, int64_t now_ms)
+{
+    if (seq <= sender.merged)
+        return; // replay of a record merged before the ack reached the edge
+    sender.merged = seq;
+
+    size_t used;
+    auto decoded = MetricSummary::deserialize(payload, used);
+    if (!decoded)
+    {
+        sender.open.emplace_back(seq, INT64_MIN); // nothing to wait for, ack with the rest
+        return;
+    }
+
+    MetricSummary &summary = *decoded;
+    auto key = std::make_tuple(summary.window_start_ms, summary.app_name, summary.context);
+    auto it = windows.find(key);
+    if (it != windows.end())
+    {
+        sender.open.emplace_back(seq, summary.window_start_ms);
+        ++received;
+        it->second.summary.merge(summary);
+        return;
+    }
+
+    auto upto = logged_upto.find({summary.app_name, summary.context});
+    if (upto != logged_upto.end() && summary.window_start_ms <= upto->second)
+    {
+        ++late; // its window went out already
+        sender.open.emplace_back(seq, INT64_MIN);
+        return;
+    }
+
+    sender.open.emplace_back(seq, summary.window_start_ms);
+    ++received;
+    windows.emplace(std::move(key), Window{std::move(summary), now_ms});
+}
+
+void SummaryReceiver::emitClosed(int64_t now_ms, bool all)
+{
+    for (auto it = windows.begin(); it != windows.end();)
+    {
+        if (!all && it->second.first_arrival_ms + grace_ms > now_ms)
+        {
+            ++it;
+            continue;
+        }
+
+        const MetricSummary &summary = it->second.summary;
+        int64_t &upto = logged_upto.try_emplace({summary.app_name, summary.context}, INT64_MIN).first->second;
+        upto = std::max(upto, summary.window_start_ms);
+        manager.log(summary.toLogMessage());
+        it = windows.erase(it);
+    }
+}
+
+uint64_t SummaryReceiver::ackable(Sender &sender)
+{
+    // windows still open start at or after the first remaining key, everything older was logged
+    int64_t first_open = windows.empty() ? INT64_MAX : std::get<0>(windows.begin()->first);
+    while (!sender.open.empty() && sender.open.front().second < first_open)
+    {
+        sender.acked = sender.open.front().first;
+        sender.open.pop_front();
+    }
+    return sender.acked;
+}
@@ -0,0 +1,330 @@
+#include "TailServer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace
+{
+    int listenOn(int fd, const sockaddr *addr, socklen_t len, const std::string &what)
+    {
+        if (fd == -1)
+            throw std::runtime_error("Failed to create socket: " + std::string(std::strerror(errno)));
+        if (::bind(fd, addr, len) == -1 || ::listen(fd, 16) == -1)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to listen on " + what + ": " + std::strerror(errno));
+        }
+        return fd;
+    }
+}
+
+TailServer::TailServer(uint16_t port, std::string unix_path, size_t max_buffer, int batch_ms)
+    : unix_path(std::move(unix_path)), max_buffer(max_buffer), batch_ms(std::max(batch_ms, 1))
+{
+    if (port == 0 && this->unix_path.empty())
+        throw std::runtime_error("TailServer needs a port or a unix socket path");
+
+    if (port != 0)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // local operators only
+
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int on = 1;
+        if (fd != -1)
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        tcp_fd = listenOn(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr), "port " + std::to_string(port));
+    }
+
+    if (!this->unix_path.empty())
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (this->unix_path.size() >= sizeof(addr.sun_path))
+        {
+            if (tcp_fd != -1)
+                ::close(tcp_fd);
+            throw std::runtime_error("Unix socket path too long: " + this->unix_path);
+        }
+        std::strcpy(addr.sun_path, this->unix_path.c_str());
+        ::unlink(addr.sun_path); // left over from a previous run
+
+        try
+        {
+            unix_fd = listenOn(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0),
+                               reinterpret_cast<sockaddr *>(&addr), sizeof(addr), this->unix_path);
+        }
+        catch (...)
+        {
+            if (tcp_fd != -1)
+                ::close(tcp_fd);
+            throw;
+        }
+    }
+}
+
+TailServer::~TailServer()
+{
+    stop();
+    for (auto &[fd, subscriber] : subscribers)
+        ::close(fd);
+    if (tcp_fd != -1)
+        ::close(tcp_fd);
+    if (unix_fd != -1)
+    {
+        ::close(unix_fd);
+        ::unlink(unix_path.c_str());
+    }
+}
+
+void TailServer::start()
+{
+    running = true;
+    worker = std::thread([this]()
+                         { run(); });
+}
+
+void TailServer::stop()
+{
+    running = false;
+    if (worker.joinable())
+        worker.join();
+}
+
+size_t TailServer::subscriberCount()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return subscribers.size();
+}
+
+void TailServer::publish(const LogMessage &message)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (groups.empty())
+        return;
+
+    // both computed at most once per message, whatever the number of groups
+    std::optional<std::optional<float>> value;
+    std::string line;
+
+    for (auto &[key, group] : groups)
+    {
+        if (group.filter.needsValue() && !value)
+            value = parseLogValue(message.message);
+        if (!group.filter.matches(message, value.value_or(std::nullopt)))
+            continue;
+
+        if (line.empty())
+        {
+            std::ostringstream os;
+            os << message;
+            line = os.str();
+        }
+
+        for (int fd : group.members)
+        {
+            Subscriber &subscriber = subscribers.at(fd);
+            if (subscriber.dropped)
+                continue;
+            if (subscriber.out.size() + line.size() > max_buffer)
+            {
+                subscriber.dropped = true; // closed by the server thread
+                continue;
+            }
+            subscriber.out += line;
+        }
+    }
+}
+
+void TailServer::run()
+{
+    std::vector<pollfd> fds;
+    auto next_flush = std::chrono::steady_clock::now();
+
+    while (running)
+    {
+        fds.clear();
+        for (int fd : {tcp_fd, unix_fd})
+            if (fd != -1)
+                fds.push_back({fd, POLLIN, 0});
+        size_t listeners = fds.size();
+        for (auto &[fd, subscriber] : subscribers) // only this thread adds or removes entries
+            if (!subscriber.input_closed)
+                fds.push_back({fd, POLLIN, 0});
+
+        int wait = static_cast<int>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                             next_flush - std::chrono::steady_clock::now())
+                                                             .count()));
+        int ready = ::poll(fds.data(), fds.size(), wait);
+
+        for (size_t i = 0; ready > 0 && i < fds.size(); ++i)
+        {
+            if (!fds[i].revents)
+                continue;
+            if (i < listeners)
+            {
+                int fd = ::accept4(fds[i].fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                if (fd != -1)
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    subscribers.emplace(fd, Subscriber{fd, {}, {}, {}});
+                }
+                continue;
+            }
+            readFilter(subscribers.at(fds[i].fd));
+        }
+
+        // output goes out in batches, not per message
+        if (std::chrono::steady_clock::now() >= next_flush)
+        {
+            flushOutput();
+            next_flush = std::chrono::steady_clock::now() + std::chrono::milliseconds(batch_ms);
+        }
+    }
+    flushOutput();
+}
+
+void TailServer::readFilter(Subscriber &subscriber)
+{
+    char chunk[1024];
+    ssize_t n = ::recv(subscriber.fd, chunk, sizeof(chunk), 0);
+    if (n == 0)
+    {
+        // half-closed ("echo filter | nc"): keep streaming, stop reading
+        subscriber.input_closed = true;
+        if (!subscriber.in.empty())
+            subscriber.in += '\n';
+    }
+    else if (n < 0)
+    {
+        if (errno == EAGAIN || errno == EINTR)
+            return;
+        std::lock_guard<std::mutex> lock(mtx);
+        subscriber.dropped = true;
+        return;
+    }
+    else
+        subscriber.in.append(chunk, static_cast<size_t>(n));
+
+    if (subscriber.in.size() > 4096)
+        subscriber.in.clear(); // not a filter line
+
+    size_t newline;
+    while ((newline = subscriber.in.find('\n')) != std::string::npos)
+    {
+        std::string line = subscriber.in.substr(0, newline);
+        subscriber.in.erase(0, newline + 1);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        std::string error;
+        auto filter = MessageFilter::parse(line, error);
+        std::string reply = filter ? "# tail " + filter->key() + "\n" : "# error " + error + "\n";
+
+        std::lock_guard<std::mutex> lock(mtx);
+        subscriber.out += reply;
+        if (filter)
+            subscribe(subscriber, std::move(*filter));
+    }
+}
+
+void TailServer::subscribe(Subscriber &subscriber, MessageFilter filter)
+{
+    leaveGroup(subscriber);
+    subscriber.group = filter.key();
+    auto &group = groups[subscriber.group];
+    if (group.members.empty())
+        group.filter = std::move(filter);
+    group.members.push_back(subscriber.fd);
+}
+
+void TailServer::leaveGroup(Subscriber &subscriber)
+{
+    if (subscriber.group.empty())
+        return;
+    auto it = groups.find(subscriber.group);
+    if (it != groups.end())
+    {
+        auto &members = it->second.members;
+        members.erase(std::remove(members.begin(), members.end(), subscriber.fd), members.end());
+        if (members.empty())
+            groups.erase(it);
+    }
+    subscriber.group.clear();
+}
+
+void TailServer::flushOutput()
+{
+    std::vector<std::pair<int, std::string>> batches;
+    std::vector<int> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto &[fd, subscriber] : subscribers)
+        {
+            if (subscriber.dropped)
+                dropped.push_back(fd);
+            else if (!subscriber.out.empty())
+                batches.emplace_back(fd, std::move(subscriber.out));
+            subscriber.out.clear();
+        }
+    }
+
+    // the sockets are non-blocking: whatever the kernel does not take now waits for the next batch
+    std::vector<std::pair<int, std::string>> rest;
+    for (auto &[fd, batch] : batches)
+    {
+        ssize_t n = ::send(fd, batch.data(), batch.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            dropped.push_back(fd); // gone
+            continue;
+        }
+        size_t sent = n > 0 ? static_cast<size_t>(n) : 0;
+        if (sent < batch.size())
+            rest.emplace_back(fd, batch.substr(sent));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto &[fd, remainder] : rest)
+        {
+            auto &out = subscribers.at(fd).out;
+            out.insert(0, remainder);
+            if (out.size() > max_buffer)
+                subscribers.at(fd).dropped = true;
+        }
+    }
+
+    for (int fd : dropped)
+        closeSubscriber(fd);
+}
+
+void TailServer::closeSubscriber(int fd)
+{
+    static const std::string notice = "# dropped: subscriber too slow\n";
+    bool slow;
+    size_t left;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = subscribers.find(fd);
+        if (it == subscribers.end())
+            return;
+        slow = it->second.dropped;
+        if (slow)
+            ::send(fd, notice.data(), notice.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        leaveGroup(it->second);
+        subscribers.erase(it);
+        left = subscribers.size();
+    }
+    ::close(fd);
+    std::cout << "[TailServer] subscriber " << (slow ? "dropped (too slow)" : "disconnected") << ", " << left << " left\n";
+}
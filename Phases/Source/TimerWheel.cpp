@@ -0,0 +1,82 @@
+#include "TimerWheel.hpp"
+
+TimerWheel::TimerWheel(uint64_t start_tick) : now_tick(start_tick)
+{
+    heads.fill(none);
+}
+
+TimerWheel::Handle TimerWheel::add()
+{
+    timers.emplace_back();
+    return static_cast<Handle>(timers.size() - 1);
+}
+
+void TimerWheel::link(Handle h)
+{
+    Timer &t = timers[h];
+    uint64_t expires = t.expires;
+    uint64_t delta = expires - now_tick; // 0 only while cascading into the current tick
+
+    // the lowest level whose span still covers the delay
+    int level = 0;
+    while (level < levels - 1 && delta >= (uint64_t(1) << (slot_bits * (level + 1))))
+        ++level;
+    if (level == levels - 1 && delta >= (uint64_t(1) << (slot_bits * levels)))
+        expires = now_tick + (uint64_t(1) << (slot_bits * levels)) - 1; // re-cascaded until due
+
+    uint64_t index = (expires >> (slot_bits * level)) & (slots - 1);
+    t.slot = static_cast<uint32_t>(level * slots + index);
+    t.prev = none;
+    t.next = heads[t.slot];
+    if (t.next != none)
+        timers[t.next].prev = h;
+    heads[t.slot] = h;
+}
+
+void TimerWheel::unlink(Handle h)
+{
+    Timer &t = timers[h];
+    if (t.prev != none)
+        timers[t.prev].next = t.next;
+    else
+        heads[t.slot] = t.next;
+    if (t.next != none)
+        timers[t.next].prev = t.prev;
+    t.prev = t.next = none;
+    t.slot = UINT32_MAX;
+}
+
+void TimerWheel::arm(Handle h, uint64_t expires_tick)
+{
+    if (armed(h))
+        unlink(h);
+    timers[h].expires = expires_tick > now_tick ? expires_tick : now_tick + 1;
+    link(h);
+}
+
+void TimerWheel::cancel(Handle h)
+{
+    if (armed(h))
+        unlink(h);
+}
+
+void TimerWheel::cascade(int level)
+{
+    if (level >= levels)
+        return;
+
+    uint64_t index = (now_tick >> (slot_bits * level)) & (slots - 1);
+    if (index == 0)
+        cascade(level + 1); // the level above wrapped too, refill this one first
+
+    // everything in the slot now fits a lower level
+    Handle h = heads[level * slots + index];
+    heads[level * slots + index] = none;
+    while (h != none)
+    {
+        Handle next = timers[h].next;
+        timers[h].slot = UINT32_MAX;
+        link(h);
+        h = next;
+    }
+}
@@ -0,0 +1,382 @@
+#include "WriteAheadLog.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct RecordHeader
+    {
+        uint32_t size;
+        uint32_t crc; // over seq and payload
+        uint64_t seq;
+    };
+    static_assert(sizeof(RecordHeader) == 16, "record header is written as raw bytes");
+
+    constexpr size_t max_pending = 1 << 20; // commit early past this
+    constexpr size_t read_block = 1 << 16;
+
+    constexpr std::array<uint32_t, 256> crcTable()
+    {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }
+
+    uint32_t crc32(uint32_t crc, const char *data, size_t size)
+    {
+        static constexpr auto table = crcTable();
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    uint32_t recordCrc(uint64_t seq, const char *payload, size_t size)
+    {
+        return crc32(crc32(0, reinterpret_cast<const char *>(&seq), sizeof(seq)), payload, size);
+    }
+
+    std::string segmentName(uint64_t first_seq)
+    {
+        char name[48];
+        std::snprintf(name, sizeof(name), "wal-%020llu.log", static_cast<unsigned long long>(first_seq));
+        return name;
+    }
+
+    // whole file into memory, segments are bounded by segment_bytes
+    bool readAll(int file, std::string &out)
+    {
+        out.clear();
+        char chunk[read_block];
+        while (true)
+        {
+            ssize_t n = ::read(file, chunk, sizeof(chunk));
+            if (n == -1 && errno == EINTR)
+                continue;
+            if (n < 0)
+                return false;
+            if (n == 0)
+                return true;
+            out.append(chunk, static_cast<size_t>(n));
+        }
+    }
+
+    void syncDir(const std::string &dir)
+    {
+        int d = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (d != -1)
+        {
+            ::fsync(d); // the new segment's directory entry survives a crash
+            ::close(d);
+        }
+    }
+}
+
+WriteAheadLog::WriteAheadLog(std::string dir, uint64_t segment_bytes, uint64_t max_bytes)
+    : dir(std::move(dir)), segment_bytes(std::max<uint64_t>(segment_bytes, 4096)), max_bytes(max_bytes)
+{
+    std::error_code ec;
+    fs::create_directories(this->dir, ec);
+    if (ec)
+        throw std::runtime_error("Failed to create " + this->dir + ": " + ec.message());
+
+    recover();
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    commit();
+    if (fd != -1)
+        ::close(fd);
+}
+
+void WriteAheadLog::recover()
+{
+    std::ifstream acked(dir + "/acked");
+    acked >> acked_seq;
+
+    for (const auto &entry : fs::directory_iterator(dir))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.size() != 28 || name.compare(0, 4, "wal-") != 0 || name.compare(24, 4, ".log") != 0)
+            continue;
+        segments.push_back({std::stoull(name.substr(4, 20)), entry.path().string(), 0});
+    }
+    std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b)
+              { return a.first_seq < b.first_seq; });
+
+    if (segments.empty())
+    {
+        next_seq = acked_seq + 1;
+        committed_seq = acked_seq;
+        openSegment(next_seq);
+        return;
+    }
+
+    // closed segments were synced before the roll, only the last one can hold a torn record
+    for (size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+        std::error_code ec;
+        segments[i].bytes = fs::file_size(segments[i].path, ec);
+        if (ec)
+            segments[i].bytes = 0;
+        total_bytes += segments[i].bytes;
+    }
+
+    Segment &last = segments.back();
+    fd = ::open(last.path.c_str(), O_RDWR | O_APPEND | O_CLOEXEC);
+    if (fd == -1)
+        throw std::runtime_error("Failed to open " + last.path + ": " + std::strerror(errno));
+
+    uint64_t last_seq = last.first_seq - 1;
+    last.bytes = scanValid(fd, last.first_seq, last_seq);
+    if (static_cast<uint64_t>(::lseek(fd, 0, SEEK_END)) != last.bytes)
+    {
+        std::cout << "[WriteAheadLog] torn tail cut from " << last.path << "\n";
+        if (::ftruncate(fd, static_cast<off_t>(last.bytes)) == -1)
+            throw std::runtime_error("Failed to truncate " + last.path + ": " + std::strerror(errno));
+    }
+    total_bytes += last.bytes;
+
+    next_seq = std::max(last_seq, acked_seq) + 1;
+    committed_seq = next_seq - 1;
+    if (last_seq < acked_seq)
+    {
+        // everything on disk was delivered already, continue numbering after the ack
+        ::close(fd);
+        fd = -1;
+        openSegment(next_seq);
+    }
+    removeSegments();
+
+    if (committed_seq > acked_seq)
+        std::cout << "[WriteAheadLog] " << committed_seq - acked_seq << " records to replay from " << dir << "\n";
+}
+
+uint64_t WriteAheadLog::scanValid(int file, uint64_t first_seq, uint64_t &last_seq) const
+{
+    std::string data;
+    if (::lseek(file, 0, SEEK_SET) == -1 || !readAll(file, data))
+        throw std::runtime_error("Failed to read " + segments.back().path + ": " + std::strerror(errno));
+
+    uint64_t pos = 0;
+    uint64_t expected = first_seq;
+    while (data.size() - pos >= sizeof(RecordHeader))
+    {
+        RecordHeader header;
+        std::memcpy(&header, data.data() + pos, sizeof(header));
+        if (header.seq != expected || header.size > data.size() - pos - sizeof(header) ||
+            header.crc != recordCrc(header.seq, data.data() + pos + sizeof(header), header.size))
+            break;
+
+        pos += sizeof(header) + header.size;
+        last_seq = expected++;
+    }
+    return pos;
+}
+
+void WriteAheadLog::openSegment(uint64_t first_seq)
+{
+    std::string path = dir + "/" + segmentName(first_seq);
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1)
+        throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+    syncDir(dir);
+    segments.push_back({first_seq, std::move(path), 0});
+}
+
+uint64_t WriteAheadLog::append(std::string_view payload)
+{
+    RecordHeader header{static_cast<uint32_t>(payload.size()), recordCrc(next_seq, payload.data(), payload.size()), next_seq};
+    pending.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    pending.append(payload);
+
+    if (pending.size() >= max_pending)
+        commit();
+    return next_seq++;
+}
+
+void WriteAheadLog::commit()
+{
+    if (pending.empty())
+        return;
+
+    if (segments.back().bytes >= segment_bytes)
+    {
+        ::close(fd);
+        fd = -1;
+        openSegment(committed_seq + 1);
+    }
+
+    // one sequential write and one sync for the whole group
+    size_t written = 0;
+    while (written < pending.size())
+    {
+        ssize_t n = ::write(fd, pending.data() + written, pending.size() - written);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            // keep the group for the next commit, drop the partial record it left behind
+            std::cout << "[WriteAheadLog] write failed: " << std::strerror(errno) << "\n";
+            if (::ftruncate(fd, static_cast<off_t>(segments.back().bytes)) == -1)
+                perror("ftruncate");
+            return;
+        }
+        written += static_cast<size_t>(n);
+    }
+    if (::fdatasync(fd) == -1)
+        perror("fdatasync");
+
+    segments.back().bytes += pending.size();
+    total_bytes += pending.size();
+    pending.clear();
+    committed_seq = next_seq - 1;
+
+    if (max_bytes && total_bytes > max_bytes && segments.size() > 1)
+    {
+        // receiver away for too long: give up the oldest records instead of the disk
+        uint64_t before = acked_seq;
+        while (total_bytes > max_bytes && segments.size() > 1 && acked_seq < segments[1].first_seq - 1)
+        {
+            acked_seq = segments[1].first_seq - 1;
+            removeSegments();
+        }
+        std::cout << "[WriteAheadLog] size limit reached, " << acked_seq - before << " undelivered records dropped\n";
+        persistAck();
+    }
+}
+
+void WriteAheadLog::acknowledge(uint64_t seq)
+{
+    seq = std::min(seq, committed_seq);
+    if (seq <= acked_seq)
+        return;
+    acked_seq = seq;
+    persistAck();
+    removeSegments();
+}
+
+void WriteAheadLog::persistAck()
+{
+    // not synced: a lost ack file only means replaying records the receiver already has
+    std::string tmp = dir + "/acked.tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << acked_seq << "\n";
+    }
+    std::error_code ec;
+    fs::rename(tmp, dir + "/acked", ec);
+}
+
+void WriteAheadLog::removeSegments()
+{
+    // a segment is done once the next one starts at or before the first unacked seq,
+    // the open segment always stays
+    while (segments.size() > 1 && segments[1].first_seq <= acked_seq + 1)
+    {
+        std::error_code ec;
+        fs::remove(segments.front().path, ec);
+        total_bytes -= segments.front().bytes;
+        segments.erase(segments.begin());
+
+        if (cursor.segment > 0)
+            --cursor.segment;
+        else
+            cursor.seq = 0;
+    }
+}
+
+uint64_t WriteAheadLog::read(uint64_t from_seq, size_t max_bytes,
+                             const std::function<void(uint64_t seq, std::string_view payload)> &fn)
+{
+    from_seq = std::max(from_seq, segments.front().first_seq); // older records were dropped
+    if (from_seq > committed_seq)
+        return from_seq;
+
+    if (cursor.seq == 0 || cursor.seq > from_seq)
+    {
+        size_t i = segments.size() - 1;
+        while (i > 0 && segments[i].first_seq > from_seq)
+            --i;
+        cursor = {i, 0, segments[i].first_seq};
+    }
+
+    std::string block;
+    size_t delivered = 0;
+    while (cursor.seq <= committed_seq && delivered < max_bytes)
+    {
+        const Segment &segment = segments[cursor.segment];
+        if (cursor.offset >= segment.bytes)
+        {
+            if (cursor.segment + 1 >= segments.size())
+                break;
+            cursor = {cursor.segment + 1, 0, segments[cursor.segment + 1].first_seq};
+            continue;
+        }
+
+        int file = ::open(segment.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file == -1)
+        {
+            std::cout << "[WriteAheadLog] cannot read " << segment.path << ": " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        // one large pread per block, records parsed out of it
+        size_t want = static_cast<size_t>(std::min<uint64_t>(segment.bytes - cursor.offset, max_bytes - delivered + read_block));
+        block.resize(want);
+        ssize_t n = ::pread(file, block.data(), want, static_cast<off_t>(cursor.offset));
+        ::close(file);
+        if (n <= 0)
+            break;
+        block.resize(static_cast<size_t>(n));
+
+        size_t pos = 0;
+        while (block.size() - pos >= sizeof(RecordHeader) && delivered < max_bytes)
+        {
+            RecordHeader header;
+            std::memcpy(&header, block.data() + pos, sizeof(header));
+            if (block.size() - pos - sizeof(header) < header.size)
+                break;
+
+            std::string_view payload(block.data() + pos + sizeof(header), header.size);
+            if (header.seq >= from_seq)
+            {
+                fn(header.seq, payload);
+                delivered += header.size;
+            }
+            pos += sizeof(header) + header.size;
+            cursor.seq = header.seq + 1;
+        }
+
+        if (pos == 0)
+        {
+            // a record larger than the block: read exactly it next time round
+            RecordHeader header;
+            std::memcpy(&header, block.data(), std::min(block.size(), sizeof(header)));
+            if (block.size() < sizeof(header) || header.size + sizeof(header) > segment.bytes - cursor.offset)
+                break; // corrupt, stop instead of spinning
+            max_bytes = std::max(max_bytes, delivered + header.size);
+            continue;
+        }
+        cursor.offset += pos;
+    }
+    return std::max(cursor.seq, from_seq);
+}
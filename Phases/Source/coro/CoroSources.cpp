@@ -0,0 +1,95 @@
+#include "coro/CoroSources.hpp"
+#include "safe/SafeSocket.hpp"
+
+#include <cstring>
+#include <optional>
+
+coro::Task coro::periodic(EpollExecutor &ex, std::chrono::milliseconds interval, std::function<bool()> setup,
+                          std::function<void()> tick, const std::atomic<bool> &running)
+{
+    if (setup && !setup())
+        co_return;
+
+    while (running)
+    {
+        tick();
+        co_await ex.sleep_for(interval);
+    }
+}
+
+coro::Task coro::socketLines(EpollExecutor &ex, std::string ip, uint16_t port, std::chrono::milliseconds retry,
+                             LineHandler on_line, const std::atomic<bool> &running)
+{
+    std::string pending;
+    char chunk[4096];
+
+    while (running)
+    {
+        std::optional<SafeSocket> sock;
+        try
+        {
+            sock.emplace(ip, port, true); // connect completes under epoll, not on the executor thread
+        }
+        catch (const std::exception &error)
+        {
+            std::cout << "[SocketSource] " << error.what() << "\n";
+        }
+
+        if (!sock)
+        {
+            co_await ex.sleep_for(retry); // no co_await inside a catch block
+            continue;
+        }
+
+        int fd = sock->fd();
+        co_await ex.writable(fd);
+        if (int error = sock->connectError())
+        {
+            std::cout << "[SocketSource] Failed to connect: " << std::strerror(error) << "\n";
+            ex.forget(fd);
+            sock.reset();
+            co_await ex.sleep_for(retry);
+            continue;
+        }
+        pending.clear();
+
+        while (running)
+        {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n > 0)
+            {
+                pending.append(chunk, static_cast<size_t>(n));
+                size_t start = 0;
+                for (size_t end; (end = pending.find('\n', start)) != std::string::npos; start = end + 1)
+                {
+                    std::string line = pending.substr(start, end - start);
+                    on_line(line);
+                }
+                pending.erase(0, start);
+                continue;
+            }
+            if (n == -1 && (errno == EAGAIN || errno == EINTR))
+            {
+                co_await ex.readable(fd);
+                continue;
+            }
+            break; // closed or failed
+        }
+
+        ex.forget(fd);
+        sock.reset();
+        co_await ex.sleep_for(retry);
+    }
+}
+
+coro::Task coro::onEvent(Event &event, std::function<bool(std::string &)> read,
+                         LineHandler on_line, const std::atomic<bool> &running)
+{
+    std::string raw;
+    while (running)
+    {
+        co_await event;
+        while (read(raw))
+            on_line(raw);
+    }
+}
@@ -0,0 +1,208 @@
+#include "coro/EpollExecutor.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace
+{
+    // upper bound on one epoll_wait, so run() notices running turning false
+    constexpr int max_wait_ms = 250;
+}
+
+coro::EpollExecutor::EpollExecutor()
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+        throw std::runtime_error("Failed to create epoll: " + std::string(std::strerror(errno)));
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd == -1)
+    {
+        ::close(epoll_fd);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(std::strerror(errno)));
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr; // marks the wake fd
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+}
+
+coro::EpollExecutor::~EpollExecutor()
+{
+    for (void *frame : tasks)
+        std::coroutine_handle<>::from_address(frame).destroy();
+    ::close(wake_fd);
+    ::close(epoll_fd);
+}
+
+void coro::EpollExecutor::spawn(Task task)
+{
+    auto h = task.release();
+    tasks.insert(h.address());
+    ready.push_back(h);
+}
+
+void coro::EpollExecutor::post(std::coroutine_handle<> h)
+{
+    {
+        std::lock_guard<std::mutex> lock(posted_mtx);
+        posted.push_back(h);
+    }
+    uint64_t one = 1;
+    ssize_t n = ::write(wake_fd, &one, sizeof(one));
+    (void)n; // counter already non-zero (EAGAIN) still wakes the loop
+}
+
+void coro::EpollExecutor::waitReadable(int fd, std::coroutine_handle<> h)
+{
+    waitFor(fd, EPOLLIN | EPOLLRDHUP, h);
+}
+
+void coro::EpollExecutor::waitWritable(int fd, std::coroutine_handle<> h)
+{
+    waitFor(fd, EPOLLOUT, h);
+}
+
+void coro::EpollExecutor::waitFor(int fd, uint32_t events, std::coroutine_handle<> h)
+{
+    epoll_event ev{};
+    ev.events = events | EPOLLONESHOT;
+    ev.data.ptr = h.address();
+
+    bool known = registered.count(fd) != 0;
+    if (epoll_ctl(epoll_fd, known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        perror("epoll_ctl");
+        ready.push_back(h); // let the coroutine see the error on its next read
+        return;
+    }
+    registered.insert(fd);
+}
+
+void coro::EpollExecutor::waitUntil(clock::time_point deadline, std::coroutine_handle<> h)
+{
+    timers.emplace(deadline, h);
+}
+
+void coro::EpollExecutor::forget(int fd)
+{
+    if (registered.erase(fd))
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void coro::EpollExecutor::resume(std::coroutine_handle<> h)
+{
+    h.resume();
+    if (!h.done())
+        return;
+
+    auto task = Task::handle::from_address(h.address());
+    if (task.promise().exception)
+    {
+        try
+        {
+            std::rethrow_exception(task.promise().exception);
+        }
+        catch (const std::exception &error)
+        {
+            std::cout << "[EpollExecutor] task failed: " << error.what() << "\n";
+        }
+    }
+    tasks.erase(h.address());
+    task.destroy();
+}
+
+void coro::EpollExecutor::run(const std::atomic<bool> &running)
+{
+    std::vector<std::coroutine_handle<>> batch;
+    epoll_event events[64];
+
+    while (running && !tasks.empty())
+    {
+        // resuming may queue more work, so swap before walking
+        while (!ready.empty())
+        {
+            batch.swap(ready);
+            for (auto h : batch)
+                resume(h);
+            batch.clear();
+        }
+        if (tasks.empty())
+            break;
+
+        int timeout = max_wait_ms;
+        if (!timers.empty())
+        {
+            auto until = std::chrono::ceil<std::chrono::milliseconds>(timers.top().first - clock::now()).count();
+            timeout = static_cast<int>(std::clamp<int64_t>(until, 0, max_wait_ms));
+        }
+
+        int n = epoll_wait(epoll_fd, events, 64, timeout);
+        if (n == -1 && errno != EINTR)
+        {
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            if (events[i].data.ptr == nullptr)
+            {
+                uint64_t count;
+                ssize_t r = ::read(wake_fd, &count, sizeof(count));
+                (void)r;
+                std::lock_guard<std::mutex> lock(posted_mtx);
+                ready.insert(ready.end(), posted.begin(), posted.end());
+                posted.clear();
+            }
+            else
+            {
+                ready.push_back(std::coroutine_handle<>::from_address(events[i].data.ptr));
+            }
+        }
+
+        auto now = clock::now();
+        while (!timers.empty() && timers.top().first <= now)
+        {
+            ready.push_back(timers.top().second);
+            timers.pop();
+        }
+    }
+}
+
+void coro::Event::set()
+{
+    std::coroutine_handle<> h;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!waiter)
+        {
+            signaled = true;
+            return;
+        }
+        h = std::exchange(waiter, {});
+    }
+    ex.post(h);
+}
+
+bool coro::Event::await_ready()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return std::exchange(signaled, false);
+}
+
+bool coro::Event::await_suspend(std::coroutine_handle<> h)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (std::exchange(signaled, false))
+        return false; // set() raced in after await_ready, keep running
+    waiter = h;
+    return true;
+}
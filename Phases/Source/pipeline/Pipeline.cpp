@@ -0,0 +1,479 @@
+#include "pipeline/Pipeline.hpp"
+#include "pipeline/Stages.hpp"
+#include "RingBuffer.hpp"
+#include "SpscQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+struct Pipeline::Queue
+{
+    virtual ~Queue() = default;
+    virtual bool push(PipelineItem &&item) = 0;
+    virtual bool pop(PipelineItem &item) = 0;
+};
+
+namespace
+{
+    constexpr int64_t drop_report_ms = 10000;
+    constexpr auto push_retry = std::chrono::microseconds(100); // source waiting on a full edge
+
+    // both ends serial: no locks
+    class SpscEdgeQueue final : public Pipeline::Queue
+    {
+    private:
+        SpscQueue<PipelineItem> queue;
+
+    public:
+        explicit SpscEdgeQueue(size_t capacity) : queue(capacity) {}
+        bool push(PipelineItem &&item) override { return queue.tryPush(std::move(item)); }
+        bool pop(PipelineItem &item) override
+        {
+            PipelineItem *front = queue.front();
+            if (!front)
+                return false;
+            item = std::move(*front);
+            queue.pop();
+            return true;
+        }
+    };
+
+    // an end with several workers: the mutex ring
+    class SharedEdgeQueue final : public Pipeline::Queue
+    {
+    private:
+        RingBuffer<PipelineItem> queue;
+
+    public:
+        explicit SharedEdgeQueue(size_t capacity) : queue(capacity) {}
+        bool push(PipelineItem &&item) override { return queue.tryPush(std::move(item)); }
+        bool pop(PipelineItem &item) override
+        {
+            auto popped = queue.trypop();
+            if (!popped)
+                return false;
+            item = std::move(*popped);
+            return true;
+        }
+    };
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    std::vector<std::string> names(const nlohmann::json &list)
+    {
+        std::vector<std::string> result;
+        if (list.is_string())
+            result.push_back(list.get<std::string>());
+        else if (list.is_array())
+            for (const auto &name : list)
+                result.push_back(name.get<std::string>());
+        return result;
+    }
+}
+
+struct Pipeline::Edge
+{
+    std::unique_ptr<Queue> queue;
+    size_t from;
+    size_t to;
+    bool spsc;
+    size_t capacity;
+    std::atomic<size_t> pending{0}; // readable by the producer too, unlike the queue's own indices
+    std::atomic<uint64_t> dropped{0}; // since the last report
+};
+
+struct Pipeline::Node
+{
+    std::string name;
+    std::string kind;
+    nlohmann::json config;
+    std::vector<std::string> targets; // output ports, in order
+    std::unique_ptr<Stage> stage;     // none for sources
+    size_t workers = 1;
+
+    std::vector<Edge *> inputs;
+    std::vector<Edge *> outputs; // one per target
+    std::atomic<size_t> active{0};
+    std::atomic<bool> tick_pending{false};
+
+    // outputs a full edge refused, sent before the node takes more input
+    std::mutex parked_mtx;
+    StageOutput parked;
+    std::atomic<bool> has_parked{false};
+};
+
+Pipeline::Pipeline(const nlohmann::json &config, const SinkFactory &makeSinks)
+    : batch(config.value("batch", 256))
+{
+    if (!config.contains("stages") || !config["stages"].is_array())
+        throw std::runtime_error("pipeline: \"stages\" must be an array");
+
+    build(config["stages"], config.value("queue_capacity", 1024), makeSinks);
+    pool = std::make_unique<ThreadPool>(std::max<size_t>(config.value("threads", 2), 1));
+
+    size_t spsc = std::count_if(edges.begin(), edges.end(), [](const auto &edge)
+                                { return edge->spsc; });
+    std::cout << "[Pipeline] " << nodes.size() << " stages, " << edges.size() << " queues (" << spsc << " spsc)\n";
+}
+
+Pipeline::~Pipeline()
+{
+    stop();
+}
+
+void Pipeline::build(const nlohmann::json &stages, size_t capacity, const SinkFactory &makeSinks)
+{
+    std::map<std::string, size_t> index;
+    for (const auto &stage : stages)
+    {
+        auto node = std::make_unique<Node>();
+        node->name = stage.value("name", "");
+        node->kind = stage.value("kind", "");
+        node->config = stage;
+        node->workers = std::max<size_t>(stage.value("workers", 1), 1);
+        if (node->name.empty() || !index.emplace(node->name, nodes.size()).second)
+            throw std::runtime_error("pipeline: stage without a name or with a duplicate name '" + node->name + "'");
+
+        if (node->kind == "route")
+        {
+            // ports: every target any rule or the default mentions
+            auto addTargets = [&node](const nlohmann::json &list)
+            {
+                for (auto &name : names(list))
+                    if (std::find(node->targets.begin(), node->targets.end(), name) == node->targets.end())
+                        node->targets.push_back(name);
+            };
+            for (const auto &rule : stage.value("rules", nlohmann::json::array()))
+                addTargets(rule.value("to", nlohmann::json::array()));
+            addTargets(stage.value("default", nlohmann::json::array()));
+        }
+        else
+            node->targets = names(stage.value("to", nlohmann::json::array()));
+
+        if (node->kind == "sink" ? !node->targets.empty() : node->targets.empty())
+            throw std::runtime_error("pipeline: stage '" + node->name + "' " +
+                                     (node->kind == "sink" ? "is a sink and cannot have targets" : "has no targets"));
+        nodes.push_back(std::move(node));
+    }
+
+    // edges, then Kahn's algorithm for the run order (and cycles)
+    std::vector<size_t> indegree(nodes.size(), 0);
+    for (size_t from = 0; from < nodes.size(); ++from)
+    {
+        for (const auto &target : nodes[from]->targets)
+        {
+            auto it = index.find(target);
+            if (it == index.end())
+                throw std::runtime_error("pipeline: stage '" + nodes[from]->name + "' sends to unknown stage '" + target + "'");
+            if (nodes[it->second]->kind == "source")
+                throw std::runtime_error("pipeline: stage '" + nodes[from]->name + "' sends to source '" + target + "'");
+
+            auto edge = std::make_unique<Edge>();
+            edge->from = from;
+            edge->to = it->second;
+            edge->spsc = nodes[from]->workers == 1 && nodes[it->second]->workers == 1;
+            edge->capacity = capacity;
+            if (edge->spsc)
+                edge->queue = std::make_unique<SpscEdgeQueue>(capacity);
+            else
+                edge->queue = std::make_unique<SharedEdgeQueue>(capacity);
+
+            nodes[from]->outputs.push_back(edge.get());
+            nodes[it->second]->inputs.push_back(edge.get());
+            ++indegree[it->second];
+            edges.push_back(std::move(edge));
+        }
+    }
+
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < nodes.size(); ++i)
+        if (indegree[i] == 0)
+            ready.push_back(i);
+    while (!ready.empty())
+    {
+        size_t i = ready.back();
+        ready.pop_back();
+        order.push_back(i);
+        for (Edge *edge : nodes[i]->outputs)
+            if (--indegree[edge->to] == 0)
+                ready.push_back(edge->to);
+    }
+    if (order.size() != nodes.size())
+        throw std::runtime_error("pipeline: stages form a cycle");
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        Node &node = *nodes[i];
+        const auto &cfg = node.config;
+        if (node.kind == "source")
+            source_list.push_back({node.name, cfg, i});
+        else if (node.kind == "parse")
+            node.stage = std::make_unique<ParseStage>(
+                LineParser::formatFromString(cfg.value("format", "single")), cfg.value("policy", "cpu"),
+                cfg.contains("derived") ? std::optional<DerivedMetrics>(cfg["derived"]) : std::nullopt);
+        else if (node.kind == "policy")
+            node.stage = std::make_unique<PolicyStage>();
+        else if (node.kind == "dedup")
+            node.stage = std::make_unique<DedupStage>(cfg.value("window_ms", 5000));
+        else if (node.kind == "aggregate")
+            node.stage = std::make_unique<AggregateStage>(static_cast<int64_t>(cfg.value("window_s", 60)) * 1000,
+                                                          cfg.value("pass_through", false));
+        else if (node.kind == "route")
+        {
+            auto ports = [&node](const nlohmann::json &list)
+            {
+                std::vector<int> result;
+                for (auto &name : names(list))
+                    result.push_back(static_cast<int>(std::find(node.targets.begin(), node.targets.end(), name) - node.targets.begin()));
+                return result;
+            };
+
+            std::vector<RouteStage::Rule> rules;
+            for (const auto &rule : cfg.value("rules", nlohmann::json::array()))
+            {
+                std::string error;
+                auto filter = MessageFilter::parse(rule.value("filter", ""), error);
+                if (!filter)
+                    throw std::runtime_error("pipeline: route '" + node.name + "': " + error);
+                rules.push_back({std::move(*filter), ports(rule.value("to", nlohmann::json::array()))});
+            }
+            node.stage = std::make_unique<RouteStage>(std::move(rules), ports(cfg.value("default", nlohmann::json::array())));
+        }
+        else if (node.kind == "sink")
+            node.stage = std::make_unique<SinkStage>(makeSinks(cfg));
+        else
+            throw std::runtime_error("pipeline: stage '" + node.name + "' has unknown kind '" + node.kind + "'");
+
+        if (node.workers > 1 && (!node.stage || !node.stage->parallelSafe()))
+            throw std::runtime_error("pipeline: stage '" + node.name + "' keeps state and cannot have workers > 1");
+    }
+}
+
+void Pipeline::push(size_t source_node, PipelineItem item)
+{
+    StageOutput out;
+    out.push(std::move(item));
+    forward(*nodes[source_node], out, Push::Wait);
+}
+
+void Pipeline::reportDrops()
+{
+    for (const auto &edge : edges)
+        if (uint64_t dropped = edge->dropped.exchange(0))
+            std::cout << "[Pipeline] " << nodes[edge->from]->name << " -> " << nodes[edge->to]->name << ": "
+                      << dropped << " items dropped, queue full\n";
+}
+
+void Pipeline::tick()
+{
+    int64_t now = nowMs();
+    int64_t due = next_drop_report.load();
+    if (now >= due && next_drop_report.compare_exchange_strong(due, now + drop_report_ms))
+        reportDrops();
+
+    for (auto &node : nodes)
+    {
+        if (!node->stage)
+            continue;
+        node->tick_pending = true;
+        schedule(*node);
+    }
+}
+
+bool Pipeline::tryAcquire(Node &node)
+{
+    size_t active = node.active.load();
+    while (active < node.workers)
+        if (node.active.compare_exchange_weak(active, active + 1))
+            return true;
+    return false;
+}
+
+void Pipeline::schedule(Node &node)
+{
+    if (stopping || !tryAcquire(node))
+        return; // already running (on every worker it may use), it re-checks its inputs before leaving
+    pool->push_task([this, &node]()
+                    { runNode(node); });
+}
+
+bool Pipeline::hasWork(const Node &node) const
+{
+    if (node.tick_pending)
+        return true;
+    if (node.has_parked) // input waits until the outputs have room, their consumers reschedule us
+        return std::all_of(node.outputs.begin(), node.outputs.end(), [](const Edge *edge)
+                           { return edge->pending < edge->capacity; });
+    return std::any_of(node.inputs.begin(), node.inputs.end(), [](const Edge *edge)
+                       { return edge->pending > 0; });
+}
+
+void Pipeline::park(Node &node, StageOutput &out)
+{
+    std::lock_guard<std::mutex> lock(node.parked_mtx);
+    node.parked.items.insert(node.parked.items.begin(), std::make_move_iterator(out.items.begin()),
+                             std::make_move_iterator(out.items.end()));
+    out.items.clear();
+    node.has_parked = true;
+}
+
+bool Pipeline::unpark(Node &node, Push mode)
+{
+    if (!node.has_parked)
+        return true;
+    StageOutput out;
+    {
+        std::lock_guard<std::mutex> lock(node.parked_mtx);
+        out.items.swap(node.parked.items);
+        node.has_parked = false;
+    }
+    if (forward(node, out, mode))
+        return true;
+    park(node, out);
+    return false;
+}
+
+size_t Pipeline::drain(Node &node, StageOutput &out, size_t limit, Push mode)
+{
+    if (!unpark(node, mode))
+        return 0; // still blocked downstream, the input stays queued and fills up upstream
+
+    size_t handled = 0;
+    PipelineItem item;
+    for (Edge *edge : node.inputs)
+    {
+        size_t n = 0;
+        while (n < limit && edge->queue->pop(item))
+        {
+            --edge->pending;
+            node.stage->process(std::move(item), out);
+            ++n;
+        }
+        handled += n;
+        if (n > 0 && nodes[edge->from]->has_parked)
+            schedule(*nodes[edge->from]); // room for what the producer is holding back
+
+        if (!forward(node, out, mode)) // per edge, so downstream starts early
+        {
+            park(node, out);
+            break;
+        }
+    }
+    return handled;
+}
+
+void Pipeline::runNode(Node &node)
+{
+    StageOutput out;
+    do
+    {
+        bool any = drain(node, out, batch) > 0;
+        if (node.tick_pending.exchange(false))
+        {
+            node.stage->tick(nowMs(), out);
+            if (!forward(node, out))
+                park(node, out);
+        }
+        if (any)
+            node.stage->endBatch();
+
+        // leave, then look again: a producer that pushed while we were still marked
+        // active did not schedule us
+        --node.active;
+    } while (!stopping && hasWork(node) && tryAcquire(node));
+}
+
+bool Pipeline::forward(Node &node, StageOutput &out, Push mode)
+{
+    if (out.items.empty())
+        return true;
+
+    std::vector<bool> touched(node.outputs.size(), false);
+    StageOutput refused; // from the first full edge on, so every edge keeps its order
+    auto send = [&](size_t port, PipelineItem &&item)
+    {
+        Edge *edge = node.outputs[port];
+        while (refused.items.empty())
+        {
+            if (edge->queue->push(std::move(item)))
+            {
+                ++edge->pending;
+                touched[port] = true;
+                return;
+            }
+            if (mode == Push::Inline)
+            {
+                StageOutput below;
+                drain(*nodes[edge->to], below, SIZE_MAX, Push::Inline); // final pass: make room on this thread
+            }
+            else if (mode == Push::Wait && !stopping)
+            {
+                schedule(*nodes[edge->to]); // drains while the source waits
+                std::this_thread::sleep_for(push_retry);
+            }
+            else if (mode == Push::Wait)
+            {
+                ++edge->dropped; // stopped while a source still pushed
+                return;
+            }
+            else
+                break;
+        }
+        refused.push(std::move(item), static_cast<int>(port));
+    };
+
+    for (auto &[port, item] : out.items)
+    {
+        if (port != StageOutput::all_ports)
+        {
+            if (port >= 0 && static_cast<size_t>(port) < node.outputs.size())
+                send(static_cast<size_t>(port), std::move(item));
+            continue;
+        }
+        for (size_t i = 0; i + 1 < node.outputs.size(); ++i)
+            send(i, PipelineItem(item));
+        send(node.outputs.size() - 1, std::move(item));
+    }
+    out.items.swap(refused.items);
+
+    for (size_t i = 0; i < touched.size(); ++i)
+        if (touched[i])
+            schedule(*nodes[node.outputs[i]->to]);
+    return out.items.empty();
+}
+
+void Pipeline::stop()
+{
+    if (stopping.exchange(true))
+        return;
+
+    // queued tasks still run; from here on nothing new is scheduled. join() rather than
+    // reset(): a finishing task may still read the pointer in schedule()
+    pool->join();
+
+    // final pass on this thread in topological order: upstream is empty before downstream drains
+    StageOutput out;
+    for (size_t i : order)
+    {
+        Node &node = *nodes[i];
+        if (!node.stage)
+            continue;
+        drain(node, out, SIZE_MAX, Push::Inline);
+        node.stage->finish(out);
+        forward(node, out, Push::Inline);
+        node.stage->endBatch();
+    }
+
+    reportDrops();
+}
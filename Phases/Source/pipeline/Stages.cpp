@@ -0,0 +1,188 @@
+#include "pipeline/Stages.hpp"
+#include "Formatter.hpp"
+#include <charconv>
+
+void ParseStage::process(PipelineItem &&item, StageOutput &out)
+{
+    auto *line = std::get_if<RawLine>(&item);
+    if (!line)
+    {
+        out.push(std::move(item));
+        return;
+    }
+
+    const auto &fields = parser.parse(line->text);
+    for (const auto &field : fields)
+        out.push(Metric{std::string(field.policy), std::string(field.value), parser.eventTime(), {}});
+
+    if (derived)
+        derived->compute(fields, [&](const DerivedMetrics::Derived &d, double value)
+                         {
+            char buf[32];
+            auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+            out.push(Metric{d.policy, std::string(buf, end), parser.eventTime(), d.name}); });
+}
+
+void PolicyStage::process(PipelineItem &&item, StageOutput &out)
+{
+    auto *metric = std::get_if<Metric>(&item);
+    if (!metric)
+    {
+        out.push(std::move(item));
+        return;
+    }
+
+    auto msg = formatWithPolicy(metric->policy, metric->value, metric->event_time_ms);
+    if (!msg)
+        return;
+    if (!metric->app_name.empty())
+        msg->app_name = std::move(metric->app_name);
+    out.push(std::move(*msg));
+}
+
+void DedupStage::process(PipelineItem &&item, StageOutput &out)
+{
+    auto *msg = std::get_if<LogMessage>(&item);
+    if (!msg)
+    {
+        out.push(std::move(item));
+        return;
+    }
+
+    key.assign(msg->app_name).append(1, '\x1f').append(msg->context).append(1, '\x1f').append(msg->message);
+    auto [it, inserted] = last_seen.try_emplace(key, msg->event_time_ms);
+    if (!inserted)
+    {
+        if (msg->event_time_ms - it->second < window_ms)
+            return; // repeat
+        it->second = msg->event_time_ms;
+    }
+    out.push(std::move(item));
+}
+
+void DedupStage::tick(int64_t now_ms, StageOutput &)
+{
+    for (auto it = last_seen.begin(); it != last_seen.end();)
+    {
+        if (now_ms - it->second >= window_ms)
+            it = last_seen.erase(it);
+        else
+            ++it;
+    }
+}
+
+AggregateStage::AggregateStage(int64_t window_ms, bool pass_through)
+    : window_ms(std::max<int64_t>(window_ms, 1)), pass_through(pass_through)
+{
+}
+
+void AggregateStage::process(PipelineItem &&item, StageOutput &out)
+{
+    auto *msg = std::get_if<LogMessage>(&item);
+    auto value = msg ? parseLogValue(msg->message) : std::nullopt;
+    if (!value)
+    {
+        out.push(std::move(item));
+        return;
+    }
+
+    int64_t start = msg->event_time_ms - msg->event_time_ms % window_ms;
+    auto &summary = open[{msg->app_name, msg->context, start}];
+    if (summary.count == 0)
+    {
+        summary.app_name = msg->app_name;
+        summary.context = msg->context;
+        summary.window_start_ms = start;
+        summary.window_ms = window_ms;
+    }
+    summary.add(*value, msg->level);
+
+    if (pass_through)
+        out.push(std::move(item));
+}
+
+void AggregateStage::tick(int64_t now_ms, StageOutput &out)
+{
+    close(now_ms, false, out);
+}
+
+void AggregateStage::finish(StageOutput &out)
+{
+    close(0, true, out);
+}
+
+void AggregateStage::close(int64_t now_ms, bool all, StageOutput &out)
+{
+    for (auto it = open.begin(); it != open.end();)
+    {
+        // one window of slack for samples that arrive late
+        if (!all && it->second.window_start_ms + 2 * window_ms > now_ms)
+        {
+            ++it;
+            continue;
+        }
+        out.push(it->second.toLogMessage());
+        it = open.erase(it);
+    }
+}
+
+RouteStage::RouteStage(std::vector<Rule> rules, std::vector<int> default_ports)
+    : rules(std::move(rules)), default_ports(std::move(default_ports))
+{
+    for (const auto &rule : this->rules)
+        needs_value = needs_value || rule.filter.needsValue();
+}
+
+void RouteStage::send(PipelineItem &&item, const std::vector<int> &ports, StageOutput &out)
+{
+    for (size_t i = 0; i < ports.size(); ++i)
+    {
+        if (i + 1 == ports.size())
+            out.push(std::move(item), ports[i]);
+        else
+            out.push(item, ports[i]);
+    }
+}
+
+void RouteStage::process(PipelineItem &&item, StageOutput &out)
+{
+    auto *msg = std::get_if<LogMessage>(&item);
+    if (!msg)
+    {
+        send(std::move(item), default_ports, out);
+        return;
+    }
+
+    // parsed once for every rule
+    auto value = needs_value ? parseLogValue(msg->message) : std::nullopt;
+    for (const auto &rule : rules)
+    {
+        if (rule.filter.matches(*msg, value))
+        {
+            send(std::move(item), rule.ports, out);
+            return;
+        }
+    }
+    send(std::move(item), default_ports, out);
+}
+
+void SinkStage::process(PipelineItem &&item, StageOutput &)
+{
+    auto *msg = std::get_if<LogMessage>(&item);
+    if (!msg)
+        return; // only messages reach files and consoles
+
+    for (auto &sink : sinks)
+        sink->write(*msg);
+}
+
+void SinkStage::endBatch()
+{
+    for (auto &sink : sinks)
+        sink->flush();
+}
+
+void SinkStage::finish(StageOutput &)
+{
+    endBatch();
+}
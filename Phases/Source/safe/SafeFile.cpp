@@ -10,6 +10,16 @@ SafeFile::SafeFile(const string &file_path) : path(std::move(file_path))
     }
 }
 
+SafeFile::SafeFile(const string &file_path, int flags) : path(file_path)
+{
+    fd = open(path.c_str(), flags);
+    if (fd == -1)
+    {
+        std::cout << "file" << path << "\n";
+        perror("error opening file");
+    }
+}
+
 void SafeFile::write(const string &str)
 {
     if (fd != -1)
@@ -52,6 +62,20 @@ bool SafeFile::readLine(std::string &out)
     }
 }
 
+ssize_t SafeFile::readAt(char *buf, size_t len, off_t offset)
+{
+    if (fd == -1)
+        return -1;
+
+    while (true)
+    {
+        ssize_t n = ::pread(fd, buf, len, offset);
+        if (n == -1 && errno == EINTR)
+            continue; // interrupted, retry
+        return n;
+    }
+}
+
 // move constructor
 SafeFile::SafeFile(SafeFile &&other) noexcept : path(std::move(other.path)), fd(other.fd)
 {
@@ -0,0 +1,87 @@
+#include "safe/SafeMappedFile.hpp"
+
+SafeMappedFile::SafeMappedFile(const string &file_path) : path(file_path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(std::strerror(errno)));
+
+    struct stat st{};
+    if (::fstat(fd, &st) == -1)
+    {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat " + path + ": " + std::string(std::strerror(errno)));
+    }
+
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0)
+    {
+        void *addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to mmap " + path + ": " + std::string(std::strerror(errno)));
+        }
+        data = static_cast<char *>(addr);
+        ::madvise(addr, length, MADV_SEQUENTIAL);
+    }
+
+    ::close(fd); // the mapping keeps the file alive
+}
+
+SafeMappedFile::SafeMappedFile(const string &file_path, size_t size) : path(file_path), length(size)
+{
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1)
+        throw std::runtime_error("Failed to open " + path + ": " + std::string(std::strerror(errno)));
+
+    struct stat st{};
+    if (::fstat(fd, &st) == -1 || (static_cast<size_t>(st.st_size) < size && ::ftruncate(fd, size) == -1))
+    {
+        ::close(fd);
+        throw std::runtime_error("Failed to size " + path + ": " + std::string(std::strerror(errno)));
+    }
+
+    void *addr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        throw std::runtime_error("Failed to mmap " + path + ": " + std::string(std::strerror(errno)));
+    data = static_cast<char *>(addr);
+}
+
+void SafeMappedFile::sync()
+{
+    if (data)
+        ::msync(data, length, MS_ASYNC);
+}
+
+// move constructor
+SafeMappedFile::SafeMappedFile(SafeMappedFile &&other) noexcept
+    : path(std::move(other.path)), data(other.data), length(other.length)
+{
+    other.data = nullptr;
+    other.length = 0;
+}
+
+// move assignment
+SafeMappedFile &SafeMappedFile::operator=(SafeMappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (data)
+            ::munmap(data, length);
+        path = std::move(other.path);
+        data = other.data;
+        length = other.length;
+        other.data = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+// destructor
+SafeMappedFile::~SafeMappedFile()
+{
+    if (data)
+        ::munmap(data, length);
+}
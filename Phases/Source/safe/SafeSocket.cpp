@@ -1,9 +1,9 @@
 #include "safe/SafeSocket.hpp"
 
-SafeSocket::SafeSocket(const string &ip, uint16_t port)
+SafeSocket::SafeSocket(const string &ip, uint16_t port, bool nonblocking)
     : ipAddress(ip), portNumber(port)
 {
-    sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockfd = ::socket(AF_INET, SOCK_STREAM | (nonblocking ? SOCK_NONBLOCK : 0), 0);
     if (sockfd == -1)
     {
         throw std::runtime_error("Failed to create socket: " + std::string(std::strerror(errno)));
@@ -14,18 +14,28 @@ SafeSocket::SafeSocket(const string &ip, uint16_t port)
     addr.sin_port = htons(portNumber);
     inet_pton(AF_INET, ipAddress.c_str(), &addr.sin_addr);
 
-    if (::connect(sockfd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1)
+    if (::connect(sockfd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 &&
+        !(nonblocking && errno == EINPROGRESS))
     {
         ::close(sockfd);
         throw std::runtime_error("Failed to connect: " + std::string(std::strerror(errno)));
     }
 }
 
+int SafeSocket::connectError() const
+{
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (::getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &length) == -1)
+        return errno;
+    return error;
+}
+
 bool SafeSocket::sendString(const string &message)
 {
     if (sockfd == -1)
         return false;
-    ssize_t n = ::send(sockfd, message.c_str(), message.size(), 0);
+    ssize_t n = ::send(sockfd, message.c_str(), message.size(), MSG_NOSIGNAL); // peer gone: error, not SIGPIPE
     return n == static_cast<ssize_t>(message.size());
 }
 
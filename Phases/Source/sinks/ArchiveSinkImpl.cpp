@@ -0,0 +1,56 @@
+#include "sinks/ArchiveSinkImpl.hpp"
+#include <filesystem>
+
+ArchiveSinkImpl::ArchiveSinkImpl(const std::string &dir, std::vector<MetricArchive::Resolution> layout)
+    : dir(dir), layout(std::move(layout))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+}
+
+std::string ArchiveSinkImpl::archiveName(const std::string &app, const std::string &context)
+{
+    std::string name = (app == context) ? context : app + "." + context;
+    for (char &c : name)
+        if (c == '/' || c == ' ')
+            c = '_';
+    return name + ".rrd";
+}
+
+MetricArchive *ArchiveSinkImpl::archiveFor(const LogMessage &message)
+{
+    std::string name = archiveName(message.app_name, message.context);
+    auto it = archives.find(name);
+    if (it != archives.end())
+        return it->second.get();
+
+    try
+    {
+        auto archive = std::make_unique<MetricArchive>(dir + "/" + name, layout);
+        return archives.emplace(name, std::move(archive)).first->second.get();
+    }
+    catch (const std::exception &error)
+    {
+        std::cout << "[ArchiveSinkImpl] " << error.what() << "\n";
+        archives.emplace(name, nullptr); // do not retry on every message
+        return nullptr;
+    }
+}
+
+void ArchiveSinkImpl::write(const LogMessage &message)
+{
+    // composite and summary messages carry no single value
+    auto value = parseLogValue(message.message);
+    if (!value)
+        return;
+
+    if (MetricArchive *archive = archiveFor(message))
+        archive->update(message.event_time_ms, value.value());
+}
+
+void ArchiveSinkImpl::flush()
+{
+    for (auto &[name, archive] : archives)
+        if (archive)
+            archive->sync();
+}
@@ -3,5 +3,13 @@
 
 void ConsoleSinkImpl::write(const LogMessage &message)
 {
-    std::cout << message;
+    line.str("");
+    line << message;
+    const std::string &text = line.str();
+    std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void ConsoleSinkImpl::flush()
+{
+    std::cout.flush();
 }
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "sinks/FailoverFileSinkImpl.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // backup bytes copied per flush while resyncing, well above one flush of new lines
+    // so the copy catches up, small enough to keep the logger's flush short
+    constexpr uint64_t resync_step = 1 << 20;
+    constexpr size_t read_chunk = 1 << 16;
+}
+
+FailoverFileSinkImpl::FailoverFileSinkImpl(FailoverConfig config) : cfg(std::move(config))
+{
+    primary.path = cfg.primary_path;
+    backup.path = cfg.backup_path;
+
+    if (!open(backup, false))
+        throw std::runtime_error("[FailoverFileSinkImpl] cannot open backup " + backup.path + ": " + std::strerror(errno));
+    if (cfg.index_block_lines > 0)
+        index.emplace(primary.path, cfg.index_block_lines);
+
+    prober = std::thread(&FailoverFileSinkImpl::probe, this);
+
+    if (!open(primary, false))
+        failover(std::string("cannot open: ") + std::strerror(errno), "");
+}
+
+FailoverFileSinkImpl::~FailoverFileSinkImpl()
+{
+    flush();
+    while (resyncing && resyncStep()) // nothing left to wait for, finish the copy
+        ;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    prober.join();
+
+    index.reset(); // writes the open block
+    if (primary.fd != -1)
+        ::close(primary.fd);
+    if (backup.fd != -1)
+        ::close(backup.fd);
+}
+
+bool FailoverFileSinkImpl::open(Target &target, bool append)
+{
+    if (target.fd != -1)
+        ::close(target.fd);
+
+    target.fd = ::open(target.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (append ? 0 : O_TRUNC), 0644);
+    if (target.fd == -1)
+        return false;
+
+    struct stat st;
+    target.size = ::fstat(target.fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+    return true;
+}
+
+bool FailoverFileSinkImpl::writeAll(Target &target, const std::string &text)
+{
+    size_t written = 0;
+    while (written < text.size())
+    {
+        ssize_t n = ::write(target.fd, text.data() + written, text.size() - written);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            if (n == 0)
+                errno = EIO;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    target.size += text.size();
+    return true;
+}
+
+void FailoverFileSinkImpl::write(const LogMessage &message)
+{
+    batch << message;
+    if (index)
+        pending.push_back({message.event_time_ms, LogIndex::severityBit(message.level),
+                           LogIndex::contextBit(message.context), static_cast<uint64_t>(batch.tellp())});
+}
+
+void FailoverFileSinkImpl::flush()
+{
+    std::string text = batch.str();
+    batch.str("");
+
+    if (on_backup && !resyncing && primary_ok.load(std::memory_order_acquire))
+        failback();
+
+    if (on_backup)
+    {
+        if (!text.empty() && !writeAll(backup, text))
+            std::cout << "[FailoverFileSinkImpl] backup " << backup.path << " failed too: " << std::strerror(errno) << "\n";
+        pending.clear();
+        if (resyncing)
+            resyncStep();
+        return;
+    }
+    if (text.empty())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t base = primary.size;
+    if (!writeAll(primary, text))
+    {
+        std::string reason = std::string("write failed: ") + std::strerror(errno);
+        if (::ftruncate(primary.fd, static_cast<off_t>(base)) == -1) // no partial batch left behind
+            perror("ftruncate");
+        primary.size = base;
+        pending.clear();
+        failover(reason, text);
+        return;
+    }
+    auto took = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    if (index)
+    {
+        for (const auto &line : pending)
+            index->add(line.time_ms, line.severity_bit, line.context_bit, base + line.end);
+        index->flush();
+    }
+    pending.clear();
+
+    if (took <= cfg.latency)
+        slow = 0;
+    else if (++slow >= cfg.slow_flushes)
+        failover("slow: " + std::to_string(took.count()) + " ms for one flush", "");
+}
+
+void FailoverFileSinkImpl::failover(const std::string &reason, const std::string &text)
+{
+    std::cout << "[FailoverFileSinkImpl] primary " << primary.path << " " << reason << ", writing to " << backup.path
+              << "\n";
+
+    if (primary.fd != -1)
+    {
+        ::close(primary.fd);
+        primary.fd = -1;
+    }
+    on_backup = true;
+    slow = 0;
+    backup_mark = resyncing ? resync_pos : backup.size; // lines not copied yet stay owed
+    resyncing = false;
+    if (!text.empty() && !writeAll(backup, text))
+        std::cout << "[FailoverFileSinkImpl] backup " << backup.path << " failed too: " << std::strerror(errno) << "\n";
+
+    primary_ok.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        failed = true;
+    }
+    cv.notify_all();
+}
+
+void FailoverFileSinkImpl::failback()
+{
+    primary_ok.store(false, std::memory_order_release);
+
+    uint64_t expected = primary.size;
+    if (!open(primary, true))
+    {
+        failover(std::string("cannot reopen: ") + std::strerror(errno), "");
+        return;
+    }
+    if (index && primary.size != expected)
+        index.emplace(primary.path, cfg.index_block_lines, false, primary.size); // file was replaced meanwhile
+
+    slow = 0;
+    if (cfg.resync)
+    {
+        resyncing = true;
+        resync_pos = backup_mark;
+        resync_lines = 0;
+        resyncStep();
+        return;
+    }
+    on_backup = false;
+    std::cout << "[FailoverFileSinkImpl] back on primary " << primary.path << "\n";
+}
+
+bool FailoverFileSinkImpl::resyncStep()
+{
+    // whole lines of the backup from resync_pos, at most resync_step bytes unless one line is longer
+    std::string out;
+    if (resync_pos < backup.size)
+    {
+        int in = ::open(backup.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in == -1)
+        {
+            perror("[FailoverFileSinkImpl] resync open");
+            return false;
+        }
+
+        uint64_t pos = resync_pos;
+        size_t whole = std::string::npos;
+        while (pos < backup.size && (out.size() < resync_step || whole == std::string::npos))
+        {
+            size_t old = out.size();
+            out.resize(old + std::min<uint64_t>(read_chunk, backup.size - pos));
+            ssize_t n = ::pread(in, out.data() + old, out.size() - old, static_cast<off_t>(pos));
+            if (n == -1 && errno == EINTR)
+            {
+                out.resize(old);
+                continue;
+            }
+            if (n <= 0)
+            {
+                out.resize(old);
+                break;
+            }
+            out.resize(old + static_cast<size_t>(n));
+            pos += static_cast<uint64_t>(n);
+            if (size_t nl = std::string_view(out).substr(old).rfind('\n'); nl != std::string_view::npos)
+                whole = old + nl;
+        }
+        ::close(in);
+
+        if (whole == std::string::npos)
+        {
+            std::cout << "[FailoverFileSinkImpl] resync cannot read " << backup.path << " at " << resync_pos << "\n";
+            return false;
+        }
+        out.resize(whole + 1);
+    }
+
+    std::vector<PendingLine> indexed;
+    size_t lines = 0;
+    for (size_t start = 0, nl; (nl = out.find('\n', start)) != std::string::npos; start = nl + 1)
+    {
+        ++lines;
+        if (index)
+            if (auto msg = parseLogLine(std::string_view(out).substr(start, nl - start)))
+                indexed.push_back({msg->event_time_ms, LogIndex::severityBit(msg->level),
+                                   LogIndex::contextBit(msg->context), nl + 1});
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t base = primary.size;
+    if (!out.empty() && !writeAll(primary, out))
+    {
+        std::string reason = std::string("resync failed: ") + std::strerror(errno);
+        if (::ftruncate(primary.fd, static_cast<off_t>(base)) == -1)
+            perror("ftruncate");
+        primary.size = base;
+        failover(reason, "");
+        return false;
+    }
+    auto took = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+
+    if (index && !indexed.empty())
+    {
+        for (const auto &line : indexed)
+            index->add(line.time_ms, line.severity_bit, line.context_bit, base + line.end);
+        index->flush();
+    }
+    resync_pos += out.size();
+    resync_lines += lines;
+
+    if (resync_pos >= backup.size)
+    {
+        resyncing = false;
+        on_backup = false;
+        std::cout << "[FailoverFileSinkImpl] resynced " << resync_lines << " lines from " << backup.path
+                  << ", back on primary " << primary.path << "\n";
+        return true;
+    }
+
+    // a primary that is still slow goes back to waiting for a good probe
+    if (took <= cfg.latency)
+        slow = 0;
+    else if (++slow >= cfg.slow_flushes)
+    {
+        failover("slow: " + std::to_string(took.count()) + " ms for one resync step", "");
+        return false;
+    }
+    return true;
+}
+
+void FailoverFileSinkImpl::probe()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopping)
+    {
+        cv.wait(lock, [this]
+                { return stopping || failed; });
+        if (cv.wait_for(lock, cfg.probe_interval, [this]
+                        { return stopping; }))
+            break;
+        lock.unlock();
+
+        // off the write path: the primary must open, and a synced block next to it must be quick
+        auto start = std::chrono::steady_clock::now();
+        bool ok = false;
+        int fd = ::open(primary.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd != -1)
+        {
+            ::close(fd);
+            std::string probe_path = primary.path + ".probe";
+            fd = ::open(probe_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd != -1)
+            {
+                std::string block(4096, '\0');
+                ok = ::write(fd, block.data(), block.size()) == static_cast<ssize_t>(block.size()) &&
+                     ::fdatasync(fd) == 0;
+                ::close(fd);
+                ::unlink(probe_path.c_str());
+            }
+        }
+        ok = ok && std::chrono::steady_clock::now() - start <= cfg.latency;
+
+        lock.lock();
+        if (ok)
+        {
+            failed = false;
+            primary_ok.store(true, std::memory_order_release);
+        }
+    }
+}
@@ -1,9 +1,40 @@
 #include "sinks/FileSinkImpl.hpp"
+#include <filesystem>
 
-FileSinkImpl::FileSinkImpl(const std::string &filename)
-    : file(std::ofstream(filename)) {}
+FileSinkImpl::FileSinkImpl(const std::string &filename, size_t index_block_lines, bool append)
+    : file(std::ofstream(filename, append ? std::ios::app : std::ios::trunc))
+{
+    std::error_code ec;
+    if (append)
+        offset = std::filesystem::file_size(filename, ec); // 0 for a new file
+    if (ec)
+        offset = 0;
+
+    if (index_block_lines > 0)
+        index.emplace(filename, index_block_lines, append, offset);
+}
 
 void FileSinkImpl::write(const LogMessage &message)
 {
-    file << message;
+    if (!index)
+    {
+        file << message;
+        return;
+    }
+
+    // the index needs the exact byte range of each line
+    line.str("");
+    line << message;
+    const std::string text = line.str();
+
+    file << text;
+    index->add(message, offset + text.size());
+    offset += text.size();
+}
+
+void FileSinkImpl::flush()
+{
+    file.flush();
+    if (index)
+        index->flush(); // after the log, so indexed ranges are always on disk
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "sinks/SegmentedFileSinkImpl.hpp"
+#include "LogSegments.hpp"
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    constexpr int64_t max_lead_ms = 60 * 1000; // event times ahead of the wall clock are indexed as now + this
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+SegmentedFileSinkImpl::SegmentedFileSinkImpl(const std::string &dir, const std::string &prefix, int64_t period_ms,
+                                             size_t index_block_lines, int64_t retention_ms)
+    : dir(dir), prefix(prefix), period_ms(std::max<int64_t>(period_ms, 1000)),
+      index_block_lines(std::max<size_t>(index_block_lines, 1)), retention_ms(retention_ms)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+}
+
+void SegmentedFileSinkImpl::rotate(int64_t start_ms)
+{
+    if (current)
+        current->flush();
+
+    current_start = start_ms;
+    current_path = LogSegments::segmentPath(dir, prefix, start_ms);
+    current = std::make_unique<FileSinkImpl>(current_path, index_block_lines, true);
+
+    if (retention_ms > 0)
+        LogSegments::removeOlderThan(dir, prefix, period_ms, start_ms - retention_ms, current_path);
+}
+
+void SegmentedFileSinkImpl::write(const LogMessage &message)
+{
+    // segments follow the wall clock, so a bogus "ts" can neither open a far-future
+    // segment nor age real ones out. boundaries are multiples of the period since the epoch
+    int64_t now = nowMs();
+    int64_t start = now - ((now % period_ms) + period_ms) % period_ms;
+    if (!current || start > current_start)
+        rotate(start);
+
+    // the segment's index records each line's event time, readers select segments by it
+    if (message.event_time_ms > now + max_lead_ms)
+    {
+        LogMessage clamped = message;
+        clamped.event_time_ms = now + max_lead_ms;
+        current->write(clamped);
+        return;
+    }
+    current->write(message);
+}
+
+void SegmentedFileSinkImpl::flush()
+{
+    if (current)
+        current->flush();
+}
@@ -0,0 +1,6 @@
+#include "sinks/StagingSinkImpl.hpp"
+
+void StagingSinkImpl::write(const LogMessage &message)
+{
+    backend.log(message, true); // the shard's writer waits for the merge instead of dropping
+}
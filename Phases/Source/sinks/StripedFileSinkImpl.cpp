@@ -0,0 +1,145 @@
+#include "sinks/StripedFileSinkImpl.hpp"
+#include "LogStripes.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+StripedFileSinkImpl::StripedFileSinkImpl(StripeConfig config) : cfg(std::move(config))
+{
+    if (cfg.dirs.empty())
+        throw std::runtime_error("[StripedFileSinkImpl] no stripe directories");
+
+    std::vector<std::string> files;
+    for (size_t i = 0; i < cfg.dirs.size(); ++i)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(cfg.dirs[i], ec);
+
+        auto stripe = std::make_unique<Stripe>();
+        stripe->path = LogStripes::stripePath(cfg.dirs[i], cfg.name, i);
+        stripe->fd = ::open(stripe->path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (stripe->fd == -1)
+            throw std::runtime_error("[StripedFileSinkImpl] cannot open " + stripe->path + ": " + std::strerror(errno));
+        files.push_back(stripe->path);
+        stripes.push_back(std::move(stripe));
+    }
+
+    std::string manifest_path = LogStripes::manifestPath(cfg.dirs[0], cfg.name);
+    manifest.open(manifest_path, std::ios::trunc);
+    if (!manifest.is_open())
+        throw std::runtime_error("[StripedFileSinkImpl] cannot open " + manifest_path);
+    manifest << LogStripes::headerLines(files);
+    manifest.flush();
+
+    for (auto &stripe : stripes)
+        stripe->writer = std::thread(&StripedFileSinkImpl::run, this, std::ref(*stripe));
+}
+
+StripedFileSinkImpl::~StripedFileSinkImpl()
+{
+    flush();
+    for (auto &stripe : stripes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(stripe->mtx);
+            stripe->stopping = true;
+        }
+        stripe->cv.notify_all();
+        stripe->writer.join();
+        ::close(stripe->fd);
+
+        if (uint64_t failed = stripe->failed_batches.load())
+            std::cout << "[StripedFileSinkImpl] " << failed << " batches failed to write to " << stripe->path << "\n";
+    }
+}
+
+void StripedFileSinkImpl::write(const LogMessage &message)
+{
+    // by source: the read loop's id, app name only for the app's own records
+    uint64_t key = message.source_key ? message.source_key : std::hash<std::string>{}(message.app_name);
+    size_t index = cfg.by_source ? key % stripes.size() : next;
+    Stripe &stripe = *stripes[index];
+
+    if (stripe.open.tellp() == 0)
+        stripe.min_time_ms = stripe.max_time_ms = message.event_time_ms;
+    stripe.min_time_ms = std::min(stripe.min_time_ms, message.event_time_ms);
+    stripe.max_time_ms = std::max(stripe.max_time_ms, message.event_time_ms);
+    stripe.open << message;
+
+    if (static_cast<size_t>(stripe.open.tellp()) >= cfg.batch_bytes)
+        cut(index);
+}
+
+void StripedFileSinkImpl::flush()
+{
+    for (size_t i = 0; i < stripes.size(); ++i)
+        if (stripes[i]->open.tellp() > 0)
+            cut(i);
+    manifest.flush();
+}
+
+void StripedFileSinkImpl::cut(size_t index)
+{
+    Stripe &stripe = *stripes[index];
+    std::string text = stripe.open.str();
+    stripe.open.str("");
+
+    // recorded before the writer has it, readers check the manifest against the file size
+    StripeBatch batch{seq++, static_cast<uint32_t>(index), stripe.planned, text.size(), stripe.min_time_ms,
+                      stripe.max_time_ms};
+    stripe.planned += text.size();
+    manifest << LogStripes::batchLine(batch);
+
+    {
+        std::unique_lock<std::mutex> lock(stripe.mtx);
+        stripe.cv.wait(lock, [&]
+                       { return stripe.queue.size() < cfg.queue_batches; });
+        stripe.queue.push_back({batch.offset, std::move(text)});
+    }
+    stripe.cv.notify_all();
+
+    if (!cfg.by_source)
+        next = (next + 1) % stripes.size();
+}
+
+void StripedFileSinkImpl::run(Stripe &stripe)
+{
+    std::unique_lock<std::mutex> lock(stripe.mtx);
+    for (;;)
+    {
+        stripe.cv.wait(lock, [&]
+                       { return stripe.stopping || !stripe.queue.empty(); });
+        if (stripe.queue.empty())
+            return; // stopping, everything written
+
+        auto [offset, text] = std::move(stripe.queue.front());
+        stripe.queue.pop_front();
+        lock.unlock();
+        stripe.cv.notify_all(); // room for a blocked cut()
+
+        // at the manifest's offset: a failed batch leaves a hole, not shifted successors
+        size_t written = 0;
+        while (written < text.size())
+        {
+            ssize_t n = ::pwrite(stripe.fd, text.data() + written, text.size() - written,
+                                 static_cast<off_t>(offset + written));
+            if (n == -1 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                if (stripe.failed_batches++ == 0)
+                    std::cout << "[StripedFileSinkImpl] write to " << stripe.path << " failed: " << std::strerror(errno)
+                              << "\n";
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+
+        lock.lock();
+    }
+}
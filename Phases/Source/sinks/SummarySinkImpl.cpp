@@ -0,0 +1,252 @@
+#include "sinks/SummarySinkImpl.hpp"
+#include "DeliveryFrame.hpp"
+
+#include <fstream>
+#include <random>
+#include <poll.h>
+
+namespace
+{
+    constexpr int64_t reconnect_ms = 5000;
+    constexpr size_t send_batch = 256 * 1024; // payload bytes read from the WAL per send
+    constexpr size_t send_limit = 4 << 20;    // per pass, acks are read between the passes of a long replay
+    constexpr int shutdown_ack_ms = 1000;
+    constexpr auto ack_poll = std::chrono::milliseconds(200); // sender wakeup while idle
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // stable per WAL directory, so a restarted edge is the same sender to central
+    uint64_t loadSenderId(const std::string &dir)
+    {
+        uint64_t id = 0;
+        std::ifstream in(dir + "/sender");
+        if (in >> id && id != 0)
+            return id;
+
+        std::random_device rd;
+        id = (static_cast<uint64_t>(rd()) << 32) | rd() | 1;
+        std::ofstream(dir + "/sender", std::ios::trunc) << id << "\n";
+        return id;
+    }
+}
+
+SummarySinkImpl::SummarySinkImpl(std::string central_ip, uint16_t central_port, int64_t window_ms,
+                                 const std::string &wal_dir, uint64_t wal_segment_bytes, uint64_t wal_max_bytes)
+    : central_ip(std::move(central_ip)), central_port(central_port), window_ms(std::max<int64_t>(window_ms, 1)),
+      wal(std::make_unique<WriteAheadLog>(wal_dir, wal_segment_bytes, wal_max_bytes)), sender_id(loadSenderId(wal_dir))
+{
+    sender = std::thread([this]()
+                         { run(); });
+}
+
+SummarySinkImpl::~SummarySinkImpl()
+{
+    closeWindows(0, true);
+    {
+        std::lock_guard<std::mutex> lock(wal_mtx);
+        wal->commit();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    sender.join();
+}
+
+void SummarySinkImpl::run()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    bool more = false;
+    while (!stopping)
+    {
+        if (!more)
+            cv.wait_for(lock, ack_poll, [this]()
+                        { return stopping || committed; });
+        committed = false;
+        lock.unlock();
+        more = send();
+        lock.lock();
+    }
+    lock.unlock();
+
+    // give central a moment to confirm, whatever stays unacked is replayed on the next start
+    send();
+    if (sock)
+        readAcks(shutdown_ack_ms);
+}
+
+uint64_t SummarySinkImpl::unacked()
+{
+    std::lock_guard<std::mutex> lock(wal_mtx);
+    return wal->committedSeq() - wal->ackedSeq();
+}
+
+void SummarySinkImpl::write(const LogMessage &message)
+{
+    auto value = parseLogValue(message.message);
+    if (!value)
+        return;
+
+    int64_t start = message.event_time_ms - message.event_time_ms % window_ms;
+    auto &summary = open[{message.app_name, message.context, start}];
+    if (summary.count == 0)
+    {
+        summary.app_name = message.app_name;
+        summary.context = message.context;
+        summary.window_start_ms = start;
+        summary.window_ms = window_ms;
+    }
+    summary.add(*value, message.level);
+}
+
+void SummarySinkImpl::flush()
+{
+    closeWindows(nowMs(), false);
+    {
+        std::lock_guard<std::mutex> lock(wal_mtx);
+        wal->commit(); // group commit: one sync for every window closed since the last flush
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        committed = true;
+    }
+    cv.notify_all();
+}
+
+void SummarySinkImpl::closeWindows(int64_t now_ms, bool all)
+{
+    std::string frame;
+    for (auto it = open.begin(); it != open.end();)
+    {
+        // one window of slack for samples that arrive late
+        if (!all && it->second.window_start_ms + 2 * window_ms > now_ms)
+        {
+            ++it;
+            continue;
+        }
+
+        frame.clear();
+        it->second.serialize(frame);
+        {
+            std::lock_guard<std::mutex> lock(wal_mtx);
+            wal->append(frame);
+        }
+        it = open.erase(it);
+    }
+}
+
+bool SummarySinkImpl::connect()
+{
+    int64_t now = nowMs();
+    if (now < next_connect_ms)
+        return false;
+    next_connect_ms = now + reconnect_ms;
+
+    try
+    {
+        sock.emplace(central_ip, central_port);
+    }
+    catch (const std::exception &error)
+    {
+        std::cout << "[SummarySinkImpl] " << error.what() << ", " << unacked() << " summaries waiting in the WAL\n";
+        return false;
+    }
+
+    std::string hello;
+    DeliveryFrame::put(hello, DeliveryFrame::Type::Hello, sender_id);
+    if (!sock->sendString(hello))
+    {
+        sock.reset();
+        return false;
+    }
+
+    // a new connection starts over from the last acknowledged record
+    {
+        std::lock_guard<std::mutex> lock(wal_mtx);
+        next_send = wal->ackedSeq() + 1;
+    }
+    ack_buffer.clear();
+    return true;
+}
+
+void SummarySinkImpl::readAcks(int timeout_ms)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    char chunk[512];
+
+    while (sock)
+    {
+        int wait = static_cast<int>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                             deadline - std::chrono::steady_clock::now())
+                                                             .count()));
+        pollfd pfd{sock->fd(), POLLIN, 0};
+        if (::poll(&pfd, 1, wait) <= 0)
+            return;
+
+        ssize_t n = ::recv(sock->fd(), chunk, sizeof(chunk), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+        {
+            sock.reset();
+            return;
+        }
+        if (n > 0)
+            ack_buffer.append(chunk, static_cast<size_t>(n));
+
+        // acks are cumulative, only the latest complete one matters
+        size_t whole = ack_buffer.size() - ack_buffer.size() % sizeof(uint64_t);
+        if (whole > 0)
+        {
+            uint64_t acked;
+            std::memcpy(&acked, ack_buffer.data() + whole - sizeof(acked), sizeof(acked));
+            ack_buffer.erase(0, whole);
+            std::lock_guard<std::mutex> lock(wal_mtx);
+            wal->acknowledge(acked);
+        }
+
+        if (unacked() == 0 || timeout_ms == 0)
+            return;
+    }
+}
+
+bool SummarySinkImpl::send()
+{
+    if (!sock)
+    {
+        if (unacked() == 0 || !connect())
+            return false;
+    }
+
+    readAcks(0);
+
+    std::string out;
+    size_t sent = 0;
+    while (sock && sent < send_limit)
+    {
+        out.clear();
+        uint64_t after;
+        {
+            std::lock_guard<std::mutex> lock(wal_mtx);
+            if (next_send > wal->committedSeq())
+                break;
+            after = wal->read(next_send, send_batch, [&out](uint64_t seq, std::string_view payload)
+                              { DeliveryFrame::put(out, DeliveryFrame::Type::Data, seq, payload); });
+        }
+        if (out.empty())
+            break;
+
+        if (!sock->sendString(out))
+        {
+            sock.reset(); // unacked records go out again on the next connection
+            return false;
+        }
+        next_send = after;
+        sent += out.size();
+    }
+    return sock && sent >= send_limit;
+}
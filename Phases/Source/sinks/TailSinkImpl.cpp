@@ -0,0 +1,6 @@
+#include "sinks/TailSinkImpl.hpp"
+
+void TailSinkImpl::write(const LogMessage &message)
+{
+    server->publish(message);
+}
@@ -0,0 +1,269 @@
+#include "telemetry/CgroupTelemetrySourceImpl.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <charconv>
+#include <string_view>
+#include <sys/inotify.h>
+
+namespace
+{
+    uint64_t parseU64(std::string_view text)
+    {
+        uint64_t value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return value;
+    }
+
+    // value of "<key> <number>" line in flat keyed files (cpu.stat, memory.stat)
+    uint64_t statField(std::string_view text, std::string_view key)
+    {
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos)
+                end = text.size();
+
+            std::string_view line = text.substr(pos, end - pos);
+            if (line.size() > key.size() && line.compare(0, key.size(), key) == 0 && line[key.size()] == ' ')
+                return parseU64(line.substr(key.size() + 1));
+
+            pos = end + 1;
+        }
+        return 0;
+    }
+
+    // sum of "<key>=<number>" over all devices in io.stat
+    uint64_t sumNestedField(std::string_view text, std::string_view key)
+    {
+        uint64_t total = 0;
+        size_t pos = 0;
+        while ((pos = text.find(key, pos)) != std::string_view::npos)
+        {
+            pos += key.size();
+            total += parseU64(text.substr(pos));
+        }
+        return total;
+    }
+
+    int depthOf(const std::string &relative)
+    {
+        if (relative.empty())
+            return 0;
+        int depth = 1;
+        for (char c : relative)
+            if (c == '/')
+                ++depth;
+        return depth;
+    }
+}
+
+CgroupTelemetrySrc::CgroupTelemetrySrc(string root, int max_depth)
+    : root(std::move(root)), max_depth(max_depth), buffer(4096),
+      host_memory_bytes(static_cast<uint64_t>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE)),
+      online_cpus(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)))
+{
+}
+
+CgroupTelemetrySrc::~CgroupTelemetrySrc()
+{
+    if (inotify_fd != -1)
+        ::close(inotify_fd);
+}
+
+bool CgroupTelemetrySrc::openSource()
+{
+    if (::access((root + "/cgroup.controllers").c_str(), F_OK) != 0)
+    {
+        std::cout << "[CgroupTelemetrySrc] " << root << " is not a cgroup v2 mount\n";
+        return false;
+    }
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd == -1)
+        perror("inotify_init1"); // still usable, just without hotplug of new cgroups
+
+    discover("", 0);
+    last_sample = std::chrono::steady_clock::now();
+    return true;
+}
+
+void CgroupTelemetrySrc::discover(const string &relative, int depth)
+{
+    string dir = relative.empty() ? root : root + "/" + relative;
+
+    if (!relative.empty())
+        addCgroup(relative);
+
+    if (depth >= max_depth)
+        return;
+
+    if (inotify_fd != -1)
+    {
+        int wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CREATE | IN_DELETE | IN_ONLYDIR);
+        if (wd != -1)
+            watches[wd] = relative;
+    }
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        if (!entry.is_directory(ec))
+            continue;
+        string name = entry.path().filename().string();
+        discover(relative.empty() ? name : relative + "/" + name, depth + 1);
+    }
+}
+
+void CgroupTelemetrySrc::addCgroup(const string &relative)
+{
+    string dir = root + "/" + relative + "/";
+    CgroupFiles files;
+
+    auto openIfPresent = [&dir](std::optional<SafeFile> &slot, const char *name)
+    {
+        string path = dir + name;
+        // controllers that are not enabled for this cgroup simply have no file
+        if (::access(path.c_str(), R_OK) == 0)
+            slot.emplace(path, O_RDONLY | O_CLOEXEC);
+    };
+
+    openIfPresent(files.cpu_stat, "cpu.stat");
+    openIfPresent(files.memory_current, "memory.current");
+    openIfPresent(files.memory_stat, "memory.stat");
+    openIfPresent(files.memory_max, "memory.max");
+    openIfPresent(files.io_stat, "io.stat");
+
+    cgroups.insert_or_assign(relative, std::move(files));
+}
+
+void CgroupTelemetrySrc::removeCgroup(const string &relative)
+{
+    string prefix = relative + "/";
+    for (auto it = cgroups.begin(); it != cgroups.end();)
+    {
+        if (it->first == relative || it->first.compare(0, prefix.size(), prefix) == 0)
+            it = cgroups.erase(it);
+        else
+            ++it;
+    }
+}
+
+void CgroupTelemetrySrc::drainInotify()
+{
+    if (inotify_fd == -1)
+        return;
+
+    alignas(inotify_event) char events[4096];
+    while (true)
+    {
+        ssize_t n = ::read(inotify_fd, events, sizeof(events));
+        if (n <= 0)
+            return; // EAGAIN: nothing pending
+
+        for (char *p = events; p < events + n;)
+        {
+            auto *ev = reinterpret_cast<inotify_event *>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            if (ev->mask & IN_IGNORED)
+            {
+                watches.erase(ev->wd);
+                continue;
+            }
+
+            auto parent = watches.find(ev->wd);
+            if (parent == watches.end() || !(ev->mask & IN_ISDIR) || ev->len == 0)
+                continue;
+
+            string child = parent->second.empty() ? string(ev->name) : parent->second + "/" + ev->name;
+
+            if (ev->mask & IN_CREATE)
+                discover(child, depthOf(child));
+            else if (ev->mask & IN_DELETE)
+                removeCgroup(child);
+        }
+    }
+}
+
+std::optional<std::string_view> CgroupTelemetrySrc::readFile(std::optional<SafeFile> &file)
+{
+    if (!file || !file->isOpen())
+        return std::nullopt;
+
+    while (true)
+    {
+        ssize_t n = file->readAt(buffer.data(), buffer.size(), 0);
+        if (n < 0)
+            return std::nullopt;
+        if (static_cast<size_t>(n) < buffer.size())
+            return std::string_view(buffer.data(), static_cast<size_t>(n));
+        buffer.resize(buffer.size() * 2); // file did not fit, grow and re-read
+    }
+}
+
+bool CgroupTelemetrySrc::sample()
+{
+    drainInotify();
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed_usec = std::chrono::duration<double, std::micro>(now - last_sample).count();
+    last_sample = now;
+
+    for (auto &[name, files] : cgroups)
+    {
+        std::optional<std::string_view> text = readFile(files.cpu_stat);
+        if (text && !text->empty())
+        {
+            uint64_t usage = statField(*text, "usage_usec");
+            if (files.primed && elapsed_usec > 0 && usage >= files.last_cpu_usec)
+            {
+                double cpu = (usage - files.last_cpu_usec) / (elapsed_usec * online_cpus) * 100.0;
+                pending.push_back(name + " cpu " + std::to_string(cpu));
+            }
+            files.last_cpu_usec = usage;
+        }
+
+        text = readFile(files.memory_current);
+        if (text && !text->empty())
+        {
+            uint64_t current = parseU64(*text);
+
+            // working set: page cache that can be reclaimed does not count
+            uint64_t inactive_file = statField(readFile(files.memory_stat).value_or(""), "inactive_file");
+            uint64_t working_set = current > inactive_file ? current - inactive_file : 0;
+
+            std::string_view max_text = readFile(files.memory_max).value_or("");
+            uint64_t limit = (max_text.empty() || max_text.compare(0, 3, "max") == 0) ? host_memory_bytes : parseU64(max_text);
+
+            if (limit > 0)
+                pending.push_back(name + " ram " + std::to_string(working_set * 100.0 / limit));
+        }
+
+        // a failed read is skipped rather than counted as zero bytes, which would
+        // make the next good sample report everything since boot as one interval
+        text = readFile(files.io_stat);
+        if (text)
+        {
+            uint64_t io_bytes = sumNestedField(*text, "rbytes=") + sumNestedField(*text, "wbytes=");
+            if (files.primed && elapsed_usec > 0 && io_bytes >= files.last_io_bytes)
+                pending.push_back(name + " io " + std::to_string((io_bytes - files.last_io_bytes) / elapsed_usec)); // bytes/usec == MB/s
+            files.last_io_bytes = io_bytes;
+        }
+
+        files.primed = true;
+    }
+
+    return !pending.empty();
+}
+
+bool CgroupTelemetrySrc::readSource(string &out)
+{
+    if (pending.empty())
+        return false;
+
+    out = std::move(pending.front());
+    pending.pop_front();
+    return true;
+}
@@ -32,7 +32,9 @@ bool SomeIPTelemetrySourceImpl::start()
                     {
         std::lock_guard<std::mutex> lock(data_mutex);
         last_usage = usage;
-        has_new_data.store(true); });
+        has_new_data.store(true);
+        if (notify)
+            notify(); });
 
     return true;
 }
@@ -53,3 +55,19 @@ bool SomeIPTelemetrySourceImpl::readSource(std::string &out)
     out = std::to_string(usage);
     return true;
 }
+
+void SomeIPTelemetrySourceImpl::setNotify(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(data_mutex); // waits out a callback running on the CommonAPI thread
+    notify = std::move(callback);
+}
+
+bool SomeIPTelemetrySourceImpl::readEvent(std::string &out)
+{
+    if (!has_new_data.exchange(false))
+        return false;
+
+    std::lock_guard<std::mutex> lock(data_mutex);
+    out = std::to_string(last_usage);
+    return true;
+}
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <cstdio>
+#include <filesystem>
+#include "LogIndex.hpp"
+#include "LogSegments.hpp"
+#include "LogStripes.hpp"
+#include "SimdSearch.hpp"
+#include "safe/SafeMappedFile.hpp"
+
+// usage: log_query <output.log | segments dir | output.stripes> [--prefix output] [--level Critical] [--context GPU]
+//                  [--from "YYYY-MM-DD HH:MM:SS"|epoch_ms] [--to ...] [--grep text] [--no-index]
+// blocks listed in <output.log>.idx that cannot match are skipped, the rest is
+// scanned with SimdSearch for the level token (or grep text), then checked per line.
+// a stripes manifest is merged across its stripes and printed in event-time order.
+
+namespace
+{
+    struct Query
+    {
+        std::string level_token; // "] [Critical] ["
+        std::string grep;
+        std::string context;
+        std::optional<severity_level> level;
+        int64_t from = std::numeric_limits<int64_t>::min();
+        int64_t to = std::numeric_limits<int64_t>::max();
+        uint32_t severity_mask = ~0u;
+        uint32_t context_mask = ~0u;
+        bool use_index = true;
+    };
+
+    int64_t parseTimeArg(const std::string &arg)
+    {
+        if (arg.find('-') == std::string::npos)
+            return std::stoll(arg);
+        return parseTimeStamp(arg);
+    }
+
+    bool lineMatches(const Query &q, std::string_view line)
+    {
+        if (!q.grep.empty() && SimdSearch::find(line, q.grep) == SimdSearch::npos)
+            return false;
+
+        bool need_fields = q.level || !q.context.empty() ||
+                           q.from != std::numeric_limits<int64_t>::min() || q.to != std::numeric_limits<int64_t>::max();
+        if (!need_fields)
+            return true;
+
+        auto msg = parseLogLine(line);
+        if (!msg)
+            return false;
+        if (q.level && msg->level != q.level.value())
+            return false;
+        if (!q.context.empty() && msg->context != q.context)
+            return false;
+        return msg->event_time_ms >= q.from && msg->event_time_ms <= q.to;
+    }
+
+    size_t scanRegion(const Query &q, std::string_view region)
+    {
+        size_t matches = 0;
+        std::string_view needle = !q.level_token.empty() ? std::string_view(q.level_token) : std::string_view(q.grep);
+
+        size_t pos = 0;
+        while (pos < region.size())
+        {
+            size_t begin = pos;
+            size_t hit = pos;
+            if (!needle.empty())
+            {
+                hit = SimdSearch::find(region, needle, pos);
+                if (hit == SimdSearch::npos)
+                    break;
+                size_t newline = region.rfind('\n', hit);
+                begin = (newline == std::string_view::npos) ? 0 : newline + 1;
+            }
+
+            size_t end = region.find('\n', hit);
+            if (end == std::string_view::npos)
+                end = region.size();
+
+            std::string_view line = region.substr(begin, end - begin);
+            if (lineMatches(q, line))
+            {
+                std::fwrite(line.data(), 1, line.size(), stdout);
+                std::fputc('\n', stdout);
+                ++matches;
+            }
+            pos = end + 1;
+        }
+        return matches;
+    }
+
+    struct Totals
+    {
+        size_t matches = 0;
+        size_t files = 0;
+        size_t scanned = 0;
+        size_t skipped = 0;
+        size_t unindexed = 0;
+    };
+
+    // false when the segment's index covers the whole file and no event time in it is in [from, to].
+    // the name only tells when a segment was written, late lines carry older event times
+    bool segmentMayMatch(const Query &q, const std::string &path)
+    {
+        if (!q.use_index)
+            return true;
+        auto blocks = LogIndex::read(LogIndex::indexPath(path));
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(path, ec);
+        if (blocks.empty() || ec || blocks.back().offset + blocks.back().length != size)
+            return true;
+
+        int64_t min_time = std::numeric_limits<int64_t>::max();
+        for (const auto &block : blocks)
+            min_time = std::min(min_time, block.min_time_ms);
+        return min_time <= q.to && blocks.back().max_time_upto_ms >= q.from;
+    }
+
+    void queryFile(const Query &q, const std::string &path, Totals &totals)
+    {
+        SafeMappedFile log(path);
+        std::string_view text = log.view();
+
+        std::vector<LogIndexBlock> blocks;
+        if (q.use_index)
+            blocks = LogIndex::read(LogIndex::indexPath(path));
+
+        // binary search to the first block that can reach q.from
+        size_t first = LogIndex::seek(blocks, q.from);
+        totals.skipped += first;
+
+        uint64_t indexed_end = 0;
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            const auto &block = blocks[i];
+            if (block.offset + block.length > text.size())
+                break; // index ahead of the log data that reached disk
+            indexed_end = block.offset + block.length;
+
+            if (i < first)
+                continue;
+            if (block.max_time_ms < q.from || block.min_time_ms > q.to ||
+                !(block.severity_mask & q.severity_mask) || !(block.context_mask & q.context_mask))
+            {
+                ++totals.skipped;
+                continue;
+            }
+            ++totals.scanned;
+            totals.matches += scanRegion(q, text.substr(block.offset, block.length));
+        }
+
+        // lines written after the last complete block have no index entry yet
+        totals.unindexed += text.size() - indexed_end;
+        totals.matches += scanRegion(q, text.substr(indexed_end));
+    }
+
+    bool queryStripes(const Query &q, const std::string &path, Totals &totals)
+    {
+        auto manifest = StripeManifest::read(path);
+        if (!manifest)
+        {
+            std::cerr << "cannot read stripes manifest " << path << "\n";
+            return false;
+        }
+
+        StripeReader reader(*manifest, q.from, q.to);
+        std::string_view line;
+        while (reader.next(line))
+        {
+            if (!lineMatches(q, line))
+                continue;
+            std::fwrite(line.data(), 1, line.size(), stdout);
+            std::fputc('\n', stdout);
+            ++totals.matches;
+        }
+        totals.files += manifest->files.size();
+        totals.scanned += manifest->batches.size() - reader.skippedBatches();
+        totals.skipped += reader.skippedBatches();
+        return true;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: log_query <log|segments dir|.stripes> [--prefix P] [--level L] [--context C] [--from T] [--to T] [--grep S] [--no-index]\n";
+        return 1;
+    }
+
+    std::string path = argv[1];
+    std::string prefix = "output";
+    Query q;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--no-index")
+        {
+            q.use_index = false;
+            continue;
+        }
+        ++i;
+        if (arg == "--level")
+        {
+            q.level = magic_enum::enum_cast<severity_level>(value);
+            if (!q.level)
+            {
+                std::cerr << "unknown level " << value << "\n";
+                return 1;
+            }
+            q.level_token = "] [" + value + "] [";
+            q.severity_mask = LogIndex::severityBit(q.level.value());
+        }
+        else if (arg == "--context")
+        {
+            q.context = value;
+            q.context_mask = LogIndex::contextBit(value);
+        }
+        else if (arg == "--from")
+            q.from = parseTimeArg(value);
+        else if (arg == "--to")
+            q.to = parseTimeArg(value);
+        else if (arg == "--grep")
+            q.grep = value;
+        else if (arg == "--prefix")
+            prefix = value;
+        else
+        {
+            std::cerr << "unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    Totals totals;
+
+    std::error_code ec;
+    if (path.size() > 8 && path.compare(path.size() - 8, 8, ".stripes") == 0)
+    {
+        if (!queryStripes(q, path, totals))
+            return 1;
+    }
+    else if (std::filesystem::is_directory(path, ec))
+    {
+        // segment directory: only segments whose recorded event times overlap [from, to]
+        for (const auto &segment : LogSegments::list(path, prefix))
+        {
+            if (!segmentMayMatch(q, segment.path))
+                continue;
+            queryFile(q, segment.path, totals);
+            ++totals.files;
+        }
+    }
+    else
+    {
+        queryFile(q, path, totals);
+        ++totals.files;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    std::cerr << "[log_query] " << totals.matches << " lines, " << totals.files << " files, " << totals.scanned << " blocks scanned, "
+              << totals.skipped << " skipped, " << totals.unindexed << " unindexed bytes, " << ms << " ms\n";
+    return 0;
+}
@@ -1,15 +1,34 @@
+#include <iostream>
+#include <stdexcept>
 #include "LoggingApp.hpp"
 
-int main() {
+// usage:
+//   ITI_cpp [config.json]                               live mode
+//   ITI_cpp --reprocess <config.json> <archive.log>...  batch replay of archived logs
+//   (point the file sinks of the reprocess config away from the archives, sinks truncate on open)
+int main(int argc, char *argv[]) {
+    std::string configPath = "/home/ayman/ITI/Project_cpp_iti/Phases/config.json";
+
+    if (argc >= 4 && std::string(argv[1]) == "--reprocess") {
+        try {
+            TelemetryLoggingApp app(argv[2]);
+            app.reprocess(std::vector<std::string>(argv + 3, argv + argc));
+        } catch (const std::exception &error) {
+            // missing or unreadable archive: the message names the path
+            std::cerr << "[main] reprocess failed: " << error.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc >= 2)
+        configPath = argv[1];
+
     // create app with config path
-    TelemetryLoggingApp app("/home/ayman/ITI/Project_cpp_iti/Phases/config.json");
+    TelemetryLoggingApp app(configPath);
 
-    // start all sources & writer thread
+    // start all sources & writer thread, returns after Ctrl+C once the sources stopped
     app.start();
 
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
-
     return 0;
-}
+}
\ No newline at end of file
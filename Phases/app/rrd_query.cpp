@@ -0,0 +1,83 @@
+#include <iostream>
+#include <chrono>
+#include <limits>
+#include <ctime>
+#include "MetricArchive.hpp"
+#include "LogMessage.hpp"
+
+// usage: rrd_query <archive.rrd> [--from "YYYY-MM-DD HH:MM:SS"|epoch_ms] [--to ...] [--info]
+// prints "time min max avg count" from the finest resolution that covers --from
+
+namespace
+{
+    int64_t parseTimeArg(const std::string &arg)
+    {
+        if (arg.find('-') == std::string::npos)
+            return std::stoll(arg);
+        return parseTimeStamp(arg);
+    }
+
+    std::string formatTime(int64_t time_ms)
+    {
+        std::time_t t = static_cast<std::time_t>(time_ms / 1000);
+        std::tm tm{};
+        localtime_r(&t, &tm);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        return stamp;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: rrd_query <archive.rrd> [--from T] [--to T] [--info]\n";
+        return 1;
+    }
+
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    int64_t from = now - 3600 * 1000;
+    int64_t to = now;
+    bool info = false;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--info")
+            info = true;
+        else if (arg == "--from" && i + 1 < argc)
+            from = parseTimeArg(argv[++i]);
+        else if (arg == "--to" && i + 1 < argc)
+            to = parseTimeArg(argv[++i]);
+        else
+        {
+            std::cerr << "unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    try
+    {
+        MetricArchive archive(argv[1]);
+
+        if (info)
+        {
+            for (const auto &res : archive.layout())
+                std::cout << "step " << res.step_ms / 1000 << "s x " << res.rows << " rows ("
+                          << res.step_ms / 1000 * res.rows / 3600.0 << " h)\n";
+            return 0;
+        }
+
+        for (const auto &p : archive.query(from, to, now))
+            std::cout << formatTime(p.time_ms) << " " << p.min << " " << p.max << " " << p.avg << " " << p.count << "\n";
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}